@@ -0,0 +1,71 @@
+#include "angular.h"
+
+using namespace kMathConstants;
+using namespace kPhysicalConstants;
+
+
+
+TAngularDistribution::TAngularDistribution(double age, double delta)
+{
+  // Parametrization from Neirling et al. (2006)
+  double a0 = 0.42489, a1 = 0.58371, a2 = -0.082373;
+  fA = a0+a1*age+a2*pow(age,2);
+
+  double b0 = 0.055108, b1 = -0.095587, b2 = 0.056952;
+  fB = b0+b1*age+b2*pow(age,2);
+
+  double Eth = Me/sqrt(2*delta);
+  fThetaC = 0.62694*pow(Eth,-0.60590);
+  fThetaCC = (10.509-4.9644*age)*fThetaC;
+
+  // Integral over [0,pi]
+  double pi = 2.*PiOver2;
+  fNorm = fA*(1.-exp(-pi/fThetaC))+fB*(1.-exp(-pi/fThetaCC));
+}
+
+
+
+TAngularDistribution::TAngularDistribution(double a, double b, double thetaC, double thetaCC)
+{
+  fA = a;
+  fB = b;
+  fThetaC = thetaC;
+  fThetaCC = thetaCC;
+
+  // Integral over [0,pi]
+  double pi = 2.*PiOver2;
+  fNorm = fA*(1.-exp(-pi/fThetaC))+fB*(1.-exp(-pi/fThetaCC));
+}
+
+
+
+void TAngularDistribution::Density(unsigned int size, const double * angle, double * density) const
+{
+  for(unsigned int i = 0; i < size; i++) density[i] = Density(angle[i]);
+}
+
+
+
+double TAngularDistribution::InverseCDF(double p) const
+{
+  if( p <= 0. ) return 0.;
+  if( p >= 1. ) return 180.;
+
+  // Newton's method in radians, falling back on bisection whenever a step leaves the bracket [low,high]
+  double low = 0., high = 2.*PiOver2;
+  double angle = -fThetaC*log(1.-p);
+  if( !(angle > low && angle < high) ) angle = 0.5*(low+high);
+  for(unsigned int i = 0; i < 100; i++)
+    {
+      double F = CDF(angle*RTOD)-p;
+      if( F > 0. ) high = angle;
+      else low = angle;
+      double f = (fA*(1./fThetaC)*exp(-angle/fThetaC)+fB*(1./fThetaCC)*exp(-angle/fThetaCC))/fNorm;
+      double next = f > 0. ? angle-F/f : low-1.;
+      if( !(next > low && next < high) ) next = 0.5*(low+high);
+      if( fabs(next-angle) <= 1.e-13*(1.+angle) ) {angle = next; break;}
+      angle = next;
+    }
+
+  return angle*RTOD;
+}
@@ -0,0 +1,84 @@
+#ifndef _ANGULAR_H
+#define _ANGULAR_H
+
+#include <cmath>
+
+#include "common.h"
+
+using namespace std;
+
+
+
+/*!
+  Angular distribution of the Cherenkov photons produced at one step of a shower, with respect to the shower axis
+  (Nerling et al. 2006):
+  \f[ f(\theta) \propto \frac{a}{\theta_c} e^{-\theta/\theta_c}+\frac{b}{\theta_{cc}} e^{-\theta/\theta_{cc}} \f]
+  where a, b and \f$ \theta_{cc} \f$ depend on the shower age and \f$ \theta_c \f$ on the Cherenkov energy threshold.
+  The distribution is normalized over [0,180] degrees in closed form, so that it can be evaluated at any angle
+  without tabulating it. Angles are in degrees and the density is per degree.
+ */
+class TAngularDistribution
+{
+  public :
+    //! Constructor of an empty distribution
+    TAngularDistribution() : fA(0.), fB(0.), fThetaC(1.), fThetaCC(1.), fNorm(1.) {}
+
+    //! Constructor at shower age and index of refraction minus one delta
+    TAngularDistribution(double age, double delta);
+
+    //! Constructor from the parameters a, b, thetaC and thetaCC (in radians), e.g. read back from a file
+    TAngularDistribution(double a, double b, double thetaC, double thetaCC);
+
+    //! Probability density per degree at angle
+    double Density(double angle) const
+    {
+      double angle_rad = angle*kMathConstants::DTOR;
+      return (fA*(1./fThetaC)*exp(-angle_rad/fThetaC)+fB*(1./fThetaCC)*exp(-angle_rad/fThetaCC))*kMathConstants::DTOR/fNorm;
+    }
+
+    //! Probability density per degree at the size angles, written in density
+    void Density(unsigned int size, const double * angle, double * density) const;
+
+    //! Probability to be emitted below angle
+    double CDF(double angle) const
+    {
+      double angle_rad = angle*kMathConstants::DTOR;
+      return (fA*(1.-exp(-angle_rad/fThetaC))+fB*(1.-exp(-angle_rad/fThetaCC)))/fNorm;
+    }
+
+    //! Angle below which photons are emitted with probability p in [0,1]
+    double InverseCDF(double p) const;
+
+    //! Returns #fA
+    double GetA() const {return fA;}
+
+    //! Returns #fB
+    double GetB() const {return fB;}
+
+    //! Returns #fThetaC in radians
+    double GetThetaC() const {return fThetaC;}
+
+    //! Returns #fThetaCC in radians
+    double GetThetaCC() const {return fThetaCC;}
+
+    //! Returns #fNorm
+    double GetNorm() const {return fNorm;}
+
+  private :
+    //! Weight of the first exponential
+    double fA;
+
+    //! Weight of the second exponential
+    double fB;
+
+    //! Angular scale of the first exponential in radians
+    double fThetaC;
+
+    //! Angular scale of the second exponential in radians
+    double fThetaCC;
+
+    //! Integral of the unnormalized distribution over [0,180] degrees
+    double fNorm;
+};
+
+#endif
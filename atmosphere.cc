@@ -2,6 +2,9 @@
 
 #include <iostream>
 #include <fstream>
+#include <cmath>
+
+using namespace kPhysicalConstants;
 
 vector<TAtmosphere> GetAtmosphere(string fileName)
 {
@@ -25,3 +28,58 @@ vector<TAtmosphere> GetAtmosphere(string fileName)
 
   return Atmosphere;
 }
+
+
+
+TAtmosphereProfile::TAtmosphereProfile(const vector<TAtmosphere> & atmosphere)
+{
+  unsigned int size = atmosphere.size();
+  fAltitude.resize(size);
+  fDensity.resize(size);
+  fDepth.resize(size);
+  fDelta.resize(size);
+  fThreshold.resize(size);
+  for(unsigned int i = 0; i < size; i++)
+    {
+      fAltitude[i] = atmosphere[i].fAltitude;
+      fDensity[i] = atmosphere[i].fDensity;
+      fDepth[i] = atmosphere[i].fDepth;
+      fDelta[i] = atmosphere[i].fDelta;
+      fThreshold[i] = Me/sqrt(2*fDelta[i]);
+    }
+
+  fDensityInterpolator = TInterpolator(fAltitude,fDensity);
+  fDeltaInterpolator = TInterpolator(fAltitude,fDelta);
+}
+
+
+
+double TAtmosphereProfile::GetThreshold(double altitude) const
+{
+  return Me/sqrt(2*GetDelta(altitude));
+}
+
+
+
+void TAtmosphereProfile::GetThreshold(unsigned int size, const double * altitude, double * threshold) const
+{
+  GetDelta(size,altitude,threshold);
+  for(unsigned int i = 0; i < size; i++) threshold[i] = Me/sqrt(2*threshold[i]);
+}
+
+
+
+double TAtmosphereProfile::GetFingerprint() const
+{
+  double fingerprint = 0.;
+  for(unsigned int i = 0; i < fAltitude.size(); i++) fingerprint += (i+1.)*(fAltitude[i]+fDensity[i]+fDepth[i]+fDelta[i]);
+
+  return fingerprint;
+}
+
+
+
+TAtmosphereHandle GetAtmosphereProfile(string fileName)
+{
+  return TAtmosphereHandle(new TAtmosphereProfile(GetAtmosphere(fileName)));
+}
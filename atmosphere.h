@@ -2,7 +2,11 @@
 #define _ATMOSPHERE_H_
 
 #include <vector>
+#include <string>
 #include <cstring>
+#include <memory>
+
+#include "common.h"
 
 using namespace std;
 
@@ -31,4 +35,85 @@ class TAtmosphere
 
 vector<TAtmosphere> GetAtmosphere(string fileName);
 
+
+
+/*!
+  Atmospheric model stored column by column, with the Cherenkov energy threshold derived once for all. It is meant
+  to be built once and shared read-only by all the Cherenkov calculators (see #TAtmosphereHandle). Quantities at a
+  given altitude are linearly interpolated, as Interpol does, and can be queried for many altitudes in one call.
+ */
+class TAtmosphereProfile
+{
+  public :
+    //! Constructor
+    TAtmosphereProfile(const vector<TAtmosphere> & atmosphere);
+
+    //! Number of tabulated altitudes
+    unsigned int GetSize() const {return fAltitude.size();}
+
+    //! Returns #fAltitude
+    const vector<double> & GetAltitude() const {return fAltitude;}
+
+    //! Returns #fDensity
+    const vector<double> & GetDensity() const {return fDensity;}
+
+    //! Returns #fDepth
+    const vector<double> & GetDepth() const {return fDepth;}
+
+    //! Returns #fDelta
+    const vector<double> & GetDelta() const {return fDelta;}
+
+    //! Returns #fThreshold
+    const vector<double> & GetThreshold() const {return fThreshold;}
+
+    //! Density at altitude (in km)
+    double GetDensity(double altitude) const {return fDensityInterpolator.Eval(altitude);}
+
+    //! Delta at altitude (in km)
+    double GetDelta(double altitude) const {return fDeltaInterpolator.Eval(altitude);}
+
+    //! Cherenkov energy threshold at altitude (in km)
+    double GetThreshold(double altitude) const;
+
+    //! Density at the size altitudes (in km)
+    void GetDensity(unsigned int size, const double * altitude, double * density) const {fDensityInterpolator.Eval(size,altitude,density);}
+
+    //! Delta at the size altitudes (in km)
+    void GetDelta(unsigned int size, const double * altitude, double * delta) const {fDeltaInterpolator.Eval(size,altitude,delta);}
+
+    //! Cherenkov energy threshold at the size altitudes (in km)
+    void GetThreshold(unsigned int size, const double * altitude, double * threshold) const;
+
+    //! Fingerprint of the tabulated values, to check that saved results match the atmosphere
+    double GetFingerprint() const;
+
+  private :
+    //! Altitude in km
+    vector<double> fAltitude;
+
+    //! Density in \f$ g . cm^{-3} \f$
+    vector<double> fDensity;
+
+    //! Atmospheric depth in \f$ g . cm^{-2} \f$
+    vector<double> fDepth;
+
+    //! Refractive index - 1
+    vector<double> fDelta;
+
+    //! Cherenkov energy threshold in MeV
+    vector<double> fThreshold;
+
+    //! Density as a function of altitude
+    TInterpolator fDensityInterpolator;
+
+    //! Delta as a function of altitude
+    TInterpolator fDeltaInterpolator;
+};
+
+//! Shared read-only atmospheric model
+typedef shared_ptr<const TAtmosphereProfile> TAtmosphereHandle;
+
+//! Reads the atmosphere in fileName and returns it as a shared model
+TAtmosphereHandle GetAtmosphereProfile(string fileName);
+
 #endif
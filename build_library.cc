@@ -0,0 +1,62 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+#include "atmosphere.h"
+#include "common.h"
+#include "library.h"
+#include "threadpool.h"
+
+using namespace std;
+
+
+
+void Usage(string myName)
+{
+  cout << endl;
+  cout << " Synopsis : " << endl;
+  cout << myName << " <atmospheric file> <log(Emin/[eV])> <log(Emax/[eV])> <number of energies> <maximum zenith angle>"
+       << " <number of zenith angles> <library file> [number of showers]" << endl << endl;
+
+  cout << " Description :" << endl;
+  cout << myName << " generates [number of showers] showers (100 by default) at <number of energies> energies uniform in"
+       << " log between <log(Emin/[eV])> and <log(Emax/[eV])> and <number of zenith angles> zenith angles between 0 and"
+       << " <maximum zenith angle>, and writes their mean longitudinal profile and total number of Cherenkov photons"
+       << " produced in <library file>. The library is read back by TProfileLibrary::Load." << endl;
+
+  cout << endl;
+  exit(0);
+}
+
+
+
+int main(int argc, char* argv[])
+{
+  // Command line
+  if(argc != 8 && argc != 9) Usage(argv[0]);
+  string AtmosphereFile = argv[1];
+  if( !CheckFile(AtmosphereFile) ) {cerr << "Exiting" << endl; exit(0);}
+  double EnergyMin = pow(10,atof(argv[2]));
+  double EnergyMax = pow(10,atof(argv[3]));
+  unsigned int NumberOfEnergies = atoi(argv[4]);
+  double ZenithMax = atof(argv[5]);
+  unsigned int NumberOfZenith = atoi(argv[6]);
+  string LibraryFile = argv[7];
+  unsigned int NumberOfShower = argc == 9 ? atoi(argv[8]) : 100;
+
+  // Atmosphere, shared read-only
+  TAtmosphereHandle atmosphere = GetAtmosphereProfile(AtmosphereFile);
+
+  // Wavelength range for Cherenkov photons produced (in cm)
+  double WaveMin = 300e-7, WaveMax = 400e-7;
+
+  /* Let's go */
+  TThreadPool Pool;
+  TProfileLibrary Library;
+  Library.SetCherenkov(atmosphere,WaveMin,WaveMax);
+  Library.Build(NumberOfEnergies,EnergyMin,EnergyMax,NumberOfZenith,ZenithMax,Pool,NumberOfShower);
+  if( !Library.Save(LibraryFile) ) {cerr << "Exiting" << endl; exit(0);}
+
+  cout << "Program Finished Normally" << endl;
+}
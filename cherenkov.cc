@@ -9,118 +9,562 @@ using namespace std;
 using namespace kMathConstants;
 using namespace kPhysicalConstants;
 
+//! Number of angles of the angular distributions, evenly spaced from 0 to 180 degrees
+static const unsigned int kNumberAngles = 180;
 
 
-TCherenkov::TCherenkov(const vector<TAtmosphere> & atmosphere, TShower * shower, double waveMin, double waveMax)
+
+TCherenkov::TCherenkov(const vector<TAtmosphere> & atmosphere, TShower * shower, double waveMin, double waveMax) :
+  fYield(waveMin,waveMax)
+{
+  fAtmosphere = TAtmosphereHandle(new TAtmosphereProfile(atmosphere));
+  fShower = shower;
+  fWaveMin = waveMin; // in cm
+  fWaveMax = waveMax; // in cm
+
+  Init();
+}
+
+
+
+TCherenkov::TCherenkov(const vector<TAtmosphere> & atmosphere, double waveMin, double waveMax) :
+  fYield(waveMin,waveMax)
+{
+  fAtmosphere = TAtmosphereHandle(new TAtmosphereProfile(atmosphere));
+  fShower = 0;
+  fWaveMin = waveMin; // in cm
+  fWaveMax = waveMax; // in cm
+
+  Init();
+}
+
+
+
+TCherenkov::TCherenkov(TAtmosphereHandle atmosphere, double waveMin, double waveMax) :
+  fYield(waveMin,waveMax)
+{
+  fAtmosphere = atmosphere;
+  fShower = 0;
+  fWaveMin = waveMin; // in cm
+  fWaveMax = waveMax; // in cm
+
+  Init();
+}
+
+
+
+TCherenkov::TCherenkov(TAtmosphereHandle atmosphere, double waveMin, double waveMax, const vector<double> & wave,
+                       const vector<double> & efficiency) :
+  fYield(waveMin,waveMax,wave,efficiency)
 {
   fAtmosphere = atmosphere;
+  fShower = 0;
+  fWaveMin = waveMin; // in cm
+  fWaveMax = waveMax; // in cm
+
+  Init();
+}
+
+
+
+TCherenkov::TCherenkov(const vector<TAtmosphere> & atmosphere, TShower * shower, double waveMin, double waveMax,
+                       const vector<double> & wave, const vector<double> & efficiency) :
+  fYield(waveMin,waveMax,wave,efficiency)
+{
+  fAtmosphere = TAtmosphereHandle(new TAtmosphereProfile(atmosphere));
   fShower = shower;
   fWaveMin = waveMin; // in cm
   fWaveMax = waveMax; // in cm
 
-  if( !fShower->GetStatus() ) {cout << "Generate shower first. EXITING." << endl; exit(0);}
+  Init();
 }
 
 
 
 TCherenkov::~TCherenkov()
 {
-  if( fShower ) delete fShower;
+  if( fOwnShower ) delete fShower;
+  if( fPhotonTable ) delete fPhotonTable;
+  if( fSpectralYield ) delete fSpectralYield;
+}
+
+
+
+void TCherenkov::SetShower(TShower * shower)
+{
+  if( shower && !shower->GetStatus() ) {cout << "Generate shower first. EXITING." << endl; exit(0);}
+
+  if( shower == fShower ) return; // already bound, and still owned if it was given to the constructor
+
+  if( fOwnShower ) delete fShower;
+  fShower = shower;
+  fOwnShower = false;
+}
+
+
+
+void TCherenkov::Init()
+{
+  if( fShower && !fShower->GetStatus() ) {cout << "Generate shower first. EXITING." << endl; exit(0);}
+
+  fOwnShower = fShower != 0; // the shower given to the constructor is deleted with TCherenkov
+  fEe = Bins(100,1,10000,true); // Electrons energy between 1 MeV and 10 GeV
+  fLogEe.resize(fEe.size());
+  for(unsigned int j = 0; j < fEe.size(); j++) fLogEe[j] = log(fEe[j]);
+  fSc.resize(fEe.size());
+  fPhotonTable = 0;
+  fSpectralYield = 0;
+  fCurvedGeometry = false;
 }
 
 
 
 void TCherenkov::ComputeTotalNumberPhotons(vector<double> & T, vector<double> & Nc)
 {
-  /* Shower */
-  // Longitudinal development
-  unsigned int size_shower = fShower->GetStep();
-  vector<double> Ne;
-  fShower->GetLongitudinalProfile(T,Ne);
-  // Depth at maximum development
-  double Tmax = fShower->GetTmax();
-  // Incoming direction
-  double theta, phi;
-  fShower->GetIncomingDirection(theta,phi);
+  if( !fShower ) {cout << "No shower to compute. EXITING." << endl; exit(0);}
 
-  /* Slant depth to age */
-  vector<double> age = depth2age(T,Tmax);
+  TWorkspaceFrame frame;
+  TStepParameters step;
+  ComputeStepParameters(1,&fShower,T,frame,step);
+  Nc.resize(step.fSize);
+  ComputeTotalNumberPhotons(step,frame,&Nc[0]);
+}
 
-  /* Slant depth to altitude */
-  vector<double> altitude(size_shower);
-  for(unsigned int i = 0; i < size_shower; i++) altitude[i] = depth2altitude(T[i]*X0*cos(theta*DTOR));
 
-  /* Linear interpolation of density and delta at altitude */
-  DECLARE_VECTOR(double,altitude_table,fAtmosphere,fAltitude);
-  DECLARE_VECTOR(double,density_table,fAtmosphere,fDensity);
-  DECLARE_VECTOR(double,delta_table,fAtmosphere,fDelta);
-  vector<double> density = Interpol(altitude_table,density_table,altitude);
-  vector<double> delta = Interpol(altitude_table,delta_table,altitude);
 
+void TCherenkov::ComputeTotalNumberPhotons(const vector<TShower *> & showers, vector<double> & T, vector<double> & Nc)
+{
+  if( showers.empty() ) {cout << "No shower to compute. EXITING." << endl; exit(0);}
+
+  TWorkspaceFrame frame;
+  TStepParameters step;
+  ComputeStepParameters(showers.size(),&showers[0],T,frame,step);
+  Nc.resize(step.fSize);
+  ComputeTotalNumberPhotons(step,frame,&Nc[0]);
+}
+
+
+
+void TCherenkov::ComputeProfile(TCherenkovProfile & profile)
+{
+  if( !fShower ) {cout << "No shower to compute. EXITING." << endl; exit(0);}
+
+  TWorkspaceFrame frame;
+  TStepParameters step;
+  ComputeStepParameters(1,&fShower,profile.fT,frame,step);
+  ComputeProfile(1,step,frame,profile);
+}
+
+
+
+void TCherenkov::ComputeProfile(const vector<TShower *> & showers, TCherenkovProfile & profile)
+{
+  if( showers.empty() ) {cout << "No shower to compute. EXITING." << endl; exit(0);}
+
+  TWorkspaceFrame frame;
+  TStepParameters step;
+  ComputeStepParameters(showers.size(),&showers[0],profile.fT,frame,step);
+  ComputeProfile(showers.size(),step,frame,profile);
+}
+
+
+
+void TCherenkov::ComputeProfile(unsigned int size_batch, const TStepParameters & step, TWorkspaceFrame & frame, TCherenkovProfile & profile)
+{
+  unsigned int size = step.fSize;
+  profile.fNumberOfShowers = size_batch;
+  profile.fNe.assign(step.fNe,step.fNe+size);
+  profile.fAge.assign(step.fAge,step.fAge+size);
+  profile.fAltitude.assign(step.fAltitude,step.fAltitude+size);
+  profile.fDensity.assign(step.fDensity,step.fDensity+size);
+  profile.fDelta.assign(step.fDelta,step.fDelta+size);
+
+  profile.fEnergyThreshold.resize(size);
+  profile.fAngularDistribution.resize(size);
+  for(unsigned int i = 0; i < size; i++)
+    {
+      profile.fEnergyThreshold[i] = EnergyThreshold(step.fDelta[i]);
+      profile.fAngularDistribution[i] = TAngularDistribution(step.fAge[i],step.fDelta[i]);
+    }
+
+  profile.fNc.resize(size);
+  ComputeTotalNumberPhotons(step,frame,&profile.fNc[0]);
+
+  if( fTransmission )
+    {
+      profile.fTransmission.resize(size);
+      for(unsigned int i = 0; i < size; i++) profile.fTransmission[i] = fTransmission->GetBandTransmission(step.fAltitude[i],step.fZenith[i%size_batch]);
+    }
+  else profile.fTransmission.clear();
+}
+
+
+
+void TCherenkov::ComputeTotalNumberPhotons(const TStepParameters & step, TWorkspaceFrame & frame, double * Nc)
+{
   /* Total number of produced Cherenkov photons */
-  Nc.resize(size_shower);
-  unsigned int size_spectrum = 100;
-  vector<double> Ee = Bins(size_spectrum,1,10000,true); // Electrons energy between 1 MeV and 10 GeV
-  for(unsigned int i = 0; i < size_shower; i++)
+  unsigned int size = step.fSize;
+  unsigned int * exact = frame.Allocate<unsigned int>(size); // steps outside of the photon table
+  unsigned int size_exact = 0;
+  for(unsigned int i = 0; i < size; i++)
     {
-      // Normalized differential electron energy spectrum at altitude 
-      vector<double> Se = ElectronEnergySpectrum(Ee,age[i]);
+      if( fPhotonTable && fPhotonTable->Contains(step.fAge[i],step.fAltitude[i]) ) Nc[i] = step.fNe[i]*fPhotonTable->Interpolate(step.fAge[i],step.fAltitude[i]);
+      else exact[size_exact++] = i;
+    }
+  if( size_exact == 0 ) return;
+
+  // Normalized differential electron energy spectra at the remaining steps
+  unsigned int size_spectrum = fEe.size();
+  double * age_exact = frame.Allocate<double>(size_exact);
+  for(unsigned int k = 0; k < size_exact; k++) age_exact[k] = step.fAge[exact[k]];
+  double * Se = frame.Allocate<double>((size_t)size_exact*size_spectrum);
+  ElectronEnergySpectrum(size_spectrum,&fEe[0],size_exact,age_exact,Se);
 
+  for(unsigned int k = 0; k < size_exact; k++)
+    {
+      unsigned int i = exact[k];
       // Normalized total number of Cherenkov photons produced
-      vector<double> LogEe, Sc; // Electron energy above threshold and corresponding number of Cherenkov photons produced
-      double yield = 0.; // Cherenkov yield
+      double NormalizedNc = NormalizedNumberPhotons(&Se[(size_t)k*size_spectrum],step.fDelta[i],step.fDensity[i]);
+
+      // Total number of Cherenkov photons produced
+      Nc[i] = step.fNe[i]*NormalizedNc;
+    }
+}
+
+
+
+void TCherenkov::SetTransmission(TTransmissionHandle transmission)
+{
+  if( transmission && !transmission->GetStatus() ) {cout << "Call TTransmission::Build first. EXITING." << endl; exit(0);}
+
+  fTransmission = transmission;
+}
+
+
+
+void TCherenkov::SetSpectralBinning(unsigned int nBins)
+{
+  if( fSpectralYield ) delete fSpectralYield;
+  fSpectralYield = new TSpectralYield(fYield,nBins);
+}
+
+
+
+void TCherenkov::SetSpectralBinning(unsigned int nBins, const vector<double> & wave, const vector<double> & ratio)
+{
+  if( fSpectralYield ) delete fSpectralYield;
+  fSpectralYield = new TSpectralYield(fYield,nBins,wave,ratio);
+}
+
+
+
+void TCherenkov::ComputeSpectrum(vector<double> & T, vector<double> & wave, TMatrix2D & photons)
+{
+  if( !fShower ) {cout << "No shower to compute. EXITING." << endl; exit(0);}
+  if( !fSpectralYield ) {cout << "Call TCherenkov::SetSpectralBinning first. EXITING." << endl; exit(0);}
+
+  TWorkspaceFrame frame;
+  TStepParameters step;
+  ComputeStepParameters(1,&fShower,T,frame,step);
+  wave = fSpectralYield->GetWave();
+  photons.Resize(step.fSize,wave.size());
+  ComputeSpectrum(step,frame,photons.GetData());
+}
+
+
+
+void TCherenkov::ComputeSpectrum(const vector<TShower *> & showers, vector<double> & T, vector<double> & wave, TMatrix2D & photons)
+{
+  if( showers.empty() ) {cout << "No shower to compute. EXITING." << endl; exit(0);}
+  if( !fSpectralYield ) {cout << "Call TCherenkov::SetSpectralBinning first. EXITING." << endl; exit(0);}
+
+  TWorkspaceFrame frame;
+  TStepParameters step;
+  ComputeStepParameters(showers.size(),&showers[0],T,frame,step);
+  wave = fSpectralYield->GetWave();
+  photons.Resize(step.fSize,wave.size());
+  ComputeSpectrum(step,frame,photons.GetData());
+}
+
+
+
+void TCherenkov::ComputeSpectrum(const TStepParameters & step, TWorkspaceFrame & frame, double * photons)
+{
+  unsigned int size = step.fSize, nBins = fSpectralYield->GetNumberOfBins();
+
+  // Normalized differential electron energy spectra at every step
+  unsigned int size_spectrum = fEe.size();
+  double * Se = frame.Allocate<double>((size_t)size*size_spectrum);
+  ElectronEnergySpectrum(size_spectrum,&fEe[0],size,step.fAge,Se);
+
+  /* Tail integrals of S and S/E^2 in log(energy) above each energy */
+  double h = fLogEe[1]-fLogEe[0];
+  double * f2 = frame.Allocate<double>(size_spectrum);
+  double * tail0 = frame.Allocate<double>(size_spectrum);
+  double * tail2 = frame.Allocate<double>(size_spectrum);
+  for(unsigned int i = 0; i < size; i++)
+    {
+      const double * S = &Se[(size_t)i*size_spectrum];
+      for(unsigned int j = 0; j < size_spectrum; j++) f2[j] = S[j]/(fEe[j]*fEe[j]);
+      CumulativeIntegrate(size_spectrum,S,h,tail0);
+      CumulativeIntegrate(size_spectrum,f2,h,tail2);
+      double total0 = tail0[size_spectrum-1], total2 = tail2[size_spectrum-1];
       for(unsigned int j = 0; j < size_spectrum; j++)
         {
-          if( Ee[j] > EnergyThreshold(delta[i])) // Cherenkov condition
-            {
-              yield = Yield(Ee[j],delta[i],density[i]);
-              LogEe.push_back(log(Ee[j]));
-              Sc.push_back(Se[j]*yield);
-            }
+          tail0[j] = total0-tail0[j];
+          tail2[j] = total2-tail2[j];
         }
-      double NormalizedNc = Integrate_nc5(LogEe,Sc);
 
-      // Total number of Cherenkov photons produced
-      Nc[i] = Ne[i]*NormalizedNc;
+      double * row = &photons[(size_t)i*nBins];
+      fSpectralYield->Yield(size_spectrum,fLogEe[0],h,tail0,tail2,step.fDelta[i],step.fDensity[i],row);
+      for(unsigned int k = 0; k < nBins; k++) row[k] *= step.fNe[i];
+    }
+}
+
+
+
+void TCherenkov::BuildPhotonTable(unsigned int nAge, unsigned int nAltitude)
+{
+  double AgeMin = 0., AgeMax = 3.;
+  double AltitudeMin = fAtmosphere->GetAltitude().front(), AltitudeMax = fAtmosphere->GetAltitude().back();
+  vector<double> age = Bins(nAge,AgeMin,AgeMax);
+  vector<double> altitude = Bins(nAltitude,AltitudeMin,AltitudeMax);
+
+  /* Linear interpolation of density and delta at altitude */
+  vector<double> density(nAltitude), delta(nAltitude);
+  fAtmosphere->GetDensity(nAltitude,&altitude[0],&density[0]);
+  fAtmosphere->GetDelta(nAltitude,&altitude[0],&delta[0]);
+
+  /* Normalized differential electron energy spectra at each age */
+  unsigned int size_spectrum = fEe.size();
+  vector<double> Se(nAge*size_spectrum);
+  ElectronEnergySpectrum(size_spectrum,&fEe[0],nAge,&age[0],&Se[0]);
+
+  /* At a given altitude, the spectra of all ages are integrated above the same threshold: the Cherenkov yield is
+     folded in the integration weights and all the ages are integrated in one call */
+  vector<double> values(nAge*nAltitude), weight(size_spectrum), column(nAge);
+  for(unsigned int j = 0; j < nAltitude; j++)
+    {
+      unsigned int first = FirstAboveThreshold(delta[j]);
+      unsigned int size = size_spectrum-first;
+      if( size < 4 ) {for(unsigned int i = 0; i < nAge; i++) values[i*nAltitude+j] = 0.; continue;}
+
+      Weights_nc5(size,fLogEe[first+1]-fLogEe[first],&weight[0]);
+      for(unsigned int k = 0; k < size; k++) weight[k] *= fYield.Yield(fEe[first+k],delta[j],density[j]);
+      Integrate_nc5(nAge,size,&Se[first],size_spectrum,&weight[0],&column[0]);
+      for(unsigned int i = 0; i < nAge; i++) values[i*nAltitude+j] = column[i];
+    }
+
+  if( fPhotonTable ) delete fPhotonTable;
+  fPhotonTable = new TTable2D(nAge,AgeMin,AgeMax,nAltitude,AltitudeMin,AltitudeMax,values);
+  double key[4];
+  PhotonTableKey(key);
+  fPhotonTable->SetKey(key);
+}
+
+
+
+bool TCherenkov::SavePhotonTable(string fileName) const
+{
+  if( !fPhotonTable ) {cout << "Call TCherenkov::BuildPhotonTable first." << endl; return false;}
+
+  return fPhotonTable->Save(fileName);
+}
+
+
+
+bool TCherenkov::LoadPhotonTable(string fileName)
+{
+  TTable2D * table = new TTable2D();
+  if( !table->Load(fileName) ) {delete table; return false;}
+
+  double key[4];
+  PhotonTableKey(key);
+  for(unsigned int i = 0; i < 4; i++)
+    {
+      if( fabs(table->GetKey()[i]-key[i]) > 1.e-12*fabs(key[i]) )
+        {
+          cout << fileName << " does not match the atmosphere and the wavelength band." << endl;
+          delete table;
+          return false;
+        }
     }
+
+  if( fPhotonTable ) delete fPhotonTable;
+  fPhotonTable = table;
+
+  return true;
 }
 
 
+
+void TCherenkov::PhotonTableKey(double * key) const
+{
+  key[0] = fWaveMin;
+  key[1] = fWaveMax;
+  key[2] = fYield.GetBandIntegral();
+  key[3] = fAtmosphere->GetFingerprint();
+}
+
+
+
 void TCherenkov::ComputeAngularDistribution(vector<double> & T, vector<double> & angle, vector<vector<double> > & distribution)
 {
-  /* Shower */
-  // Longitudinal development
-  unsigned int size_shower = fShower->GetStep();
-  vector<double> Ne;
-  fShower->GetLongitudinalProfile(T,Ne);
-  // Depth at maximum development
-  double Tmax = fShower->GetTmax();
-  // Incoming direction
-  double theta, phi;
-  fShower->GetIncomingDirection(theta,phi);
+  if( !fShower ) {cout << "No shower to compute. EXITING." << endl; exit(0);}
 
-  /* Slant depth to age */
-  vector<double> age = depth2age(T,Tmax); 
+  TWorkspaceFrame frame;
+  TStepParameters step;
+  ComputeStepParameters(1,&fShower,T,frame,step);
+  double * distribution_tmp = frame.Allocate<double>((size_t)step.fSize*kNumberAngles);
+  ComputeAngularDistribution(step,angle,distribution_tmp);
 
-  /* Slant depth to altitude */
-  vector<double> altitude(size_shower);
-  for(unsigned int i = 0; i < size_shower; i++) altitude[i] = depth2altitude(T[i]*X0*cos(theta*DTOR));
+  unsigned int size_shower = step.fSize;
+  distribution.resize(size_shower);
+  for(unsigned int i = 0; i < size_shower; i++)
+    distribution[i].assign(distribution_tmp+i*kNumberAngles,distribution_tmp+(i+1)*kNumberAngles);
+}
 
-  /* Linear interpolation of density and delta at altitude */
-  DECLARE_VECTOR(double,altitude_table,fAtmosphere,fAltitude);
-  DECLARE_VECTOR(double,delta_table,fAtmosphere,fDelta);
-  vector<double> delta = Interpol(altitude_table,delta_table,altitude);
 
+
+void TCherenkov::ComputeAngularDistribution(vector<double> & T, vector<double> & angle, TMatrix2D & distribution)
+{
+  if( !fShower ) {cout << "No shower to compute. EXITING." << endl; exit(0);}
+
+  TWorkspaceFrame frame;
+  TStepParameters step;
+  ComputeStepParameters(1,&fShower,T,frame,step);
+  distribution.Resize(step.fSize,kNumberAngles);
+  ComputeAngularDistribution(step,angle,distribution.GetData());
+}
+
+
+
+void TCherenkov::ComputeAngularDistribution(const vector<TShower *> & showers, vector<double> & T, vector<double> & angle, TMatrix2D & distribution)
+{
+  if( showers.empty() ) {cout << "No shower to compute. EXITING." << endl; exit(0);}
+
+  TWorkspaceFrame frame;
+  TStepParameters step;
+  ComputeStepParameters(showers.size(),&showers[0],T,frame,step);
+  distribution.Resize(step.fSize,kNumberAngles);
+  ComputeAngularDistribution(step,angle,distribution.GetData());
+}
+
+
+
+void TCherenkov::ComputeAngularDistribution(vector<double> & T, vector<TAngularDistribution> & distribution)
+{
+  if( !fShower ) {cout << "No shower to compute. EXITING." << endl; exit(0);}
+
+  TWorkspaceFrame frame;
+  TStepParameters step;
+  ComputeStepParameters(1,&fShower,T,frame,step);
+  distribution.resize(step.fSize);
+  for(unsigned int i = 0; i < step.fSize; i++) distribution[i] = TAngularDistribution(step.fAge[i],step.fDelta[i]);
+}
+
+
+
+void TCherenkov::ComputeAngularDistribution(const vector<TShower *> & showers, vector<double> & T, vector<TAngularDistribution> & distribution)
+{
+  if( showers.empty() ) {cout << "No shower to compute. EXITING." << endl; exit(0);}
+
+  TWorkspaceFrame frame;
+  TStepParameters step;
+  ComputeStepParameters(showers.size(),&showers[0],T,frame,step);
+  distribution.resize(step.fSize);
+  for(unsigned int i = 0; i < step.fSize; i++) distribution[i] = TAngularDistribution(step.fAge[i],step.fDelta[i]);
+}
+
+
+
+void TCherenkov::ComputeAngularDistribution(const vector<TShower *> & showers, vector<double> & T, vector<double> & angle, vector<double> & distribution)
+{
+  if( showers.empty() ) {cout << "No shower to compute. EXITING." << endl; exit(0);}
+
+  TWorkspaceFrame frame;
+  TStepParameters step;
+  ComputeStepParameters(showers.size(),&showers[0],T,frame,step);
+  distribution.resize((size_t)step.fSize*kNumberAngles);
+  ComputeAngularDistribution(step,angle,&distribution[0]);
+}
+
+
+
+void TCherenkov::ComputeAngularDistribution(const TStepParameters & step, vector<double> & angle, double * distribution)
+{
   // Normalized angular distribution
-  unsigned int size_angle = 180;
-  angle = Bins(size_angle,0.,180.);
-  distribution.resize(size_shower);
+  angle.resize(kNumberAngles);
+  Bins(kNumberAngles,0.,180.,false,&angle[0]);
+  for(unsigned int i = 0; i < step.fSize; i++)
+    AngularDistribution(kNumberAngles,&angle[0],step.fAge[i],step.fDelta[i],&distribution[(size_t)i*kNumberAngles]);
+}
+
+
+
+void TCherenkov::ComputeStepParameters(unsigned int size_batch, TShower * const * showers, vector<double> & T,
+                                       TWorkspaceFrame & frame, TStepParameters & step)
+{
+  /* Showers, on the depth grid shared by all the showers of the same number of steps */
+  TDepthGrid grid = showers[0]->GetDepthGrid();
+  const vector<double> & depth = *grid;
+  unsigned int size_shower = depth.size();
+  double * Tmax = frame.Allocate<double>(size_batch);
+  double * Theta = frame.Allocate<double>(size_batch);
+  for(unsigned int s = 0; s < size_batch; s++)
+    {
+      if( !showers[s]->GetStatus() ) {cout << "Generate shower first. EXITING." << endl; exit(0);}
+      if( showers[s]->GetDepthGrid() != grid ) {cout << "Showers must have the same number of steps. EXITING." << endl; exit(0);}
+      // Depth at maximum development
+      Tmax[s] = showers[s]->GetTmax();
+      // Incoming direction
+      double theta, phi;
+      showers[s]->GetIncomingDirection(theta,phi);
+      Theta[s] = theta;
+    }
+  step.fZenith = Theta;
+
+  // Longitudinal development
+  unsigned int size = size_shower*size_batch;
+  step.fSize = size;
+  step.fNe = frame.Allocate<double>(size);
+  for(unsigned int s = 0; s < size_batch; s++)
+    {
+      const vector<double> & Ne_shower = showers[s]->GetNumberOfElectrons();
+      for(unsigned int i = 0; i < size_shower; i++) step.fNe[i*size_batch+s] = Ne_shower[i];
+    }
+
+  /* Slant depth to age */
+  step.fAge = frame.Allocate<double>(size);
   for(unsigned int i = 0; i < size_shower; i++)
+    for(unsigned int s = 0; s < size_batch; s++) step.fAge[i*size_batch+s] = depth2age(depth[i],Tmax[s]);
+
+  /* Slant depth to altitude */
+  step.fAltitude = frame.Allocate<double>(size);
+  if( fCurvedGeometry )
     {
-      vector<double> distribution_tmp = AngularDistribution(angle,age[i],delta[i]);
-      distribution[i].resize(size_angle);
-      for(unsigned int j = 0; j < size_angle; j++) distribution[i][j] = distribution_tmp[j];
+      fGeometry.resize(size_batch); // no allocation once the largest batch is reached
+      GetSlantGeometry(fAtmosphere,size_batch,Theta,&fGeometry[0]);
+      for(unsigned int i = 0; i < size_shower; i++)
+        for(unsigned int s = 0; s < size_batch; s++) step.fAltitude[i*size_batch+s] = fGeometry[s]->GetAltitude(depth[i]*X0);
+      fGeometry.clear(); // keeps the capacity
     }
+  else
+    {
+      double * CosTheta = frame.Allocate<double>(size_batch);
+      for(unsigned int s = 0; s < size_batch; s++) CosTheta[s] = cos(Theta[s]*DTOR);
+      for(unsigned int i = 0; i < size_shower; i++)
+        for(unsigned int s = 0; s < size_batch; s++) step.fAltitude[i*size_batch+s] = depth2altitude(depth[i]*X0*CosTheta[s]);
+    }
+
+  /* Linear interpolation of density and delta at altitude */
+  step.fDensity = frame.Allocate<double>(size);
+  step.fDelta = frame.Allocate<double>(size);
+  fAtmosphere->GetDensity(size,step.fAltitude,step.fDensity);
+  fAtmosphere->GetDelta(size,step.fAltitude,step.fDelta);
+
+  // Depth grid handed back to the caller
+  T = depth;
 }
 
 
@@ -134,54 +578,50 @@ double TCherenkov::EnergyThreshold(double delta)
 
 
 
-double TCherenkov::Yield(double energy, double delta, double density)
+unsigned int TCherenkov::FirstAboveThreshold(double delta)
 {
-  double yield = 0.;
-
-  // Below the Cherenkov energy threshold
-  if( energy < EnergyThreshold(delta) ) return yield;
-
-  // Above the Cherenkov energy threshold. See Eq. 2 in Nerling et al. (2006)
-  unsigned int size = 1000;
-  vector<double> wave = Bins(size, fWaveMin, fWaveMax);
-  vector<double> integrand(size);
-  for(unsigned int i = 0; i < size; i++) integrand[i] = (2.*delta-pow(Me,2)/pow(energy,2))/pow(wave[i],2);
-  yield = (TwoPi*alpha/density)*Integrate_nc5(wave,integrand); 
+  double Eth = EnergyThreshold(delta);
+  unsigned int first = 0;
+  while( first < fEe.size() && !(fEe[first] > Eth) ) first++; // Cherenkov condition
 
-  return yield;
+  return first;
 }
 
 
 
-vector<double> TCherenkov::AngularDistribution(vector<double> & angle, double age, double delta)
+double TCherenkov::NormalizedNumberPhotons(const double * Se, double delta, double density)
 {
-  unsigned int size = angle.size();
-  vector<double> angle_rad(size);
-  for(unsigned int i = 0; i < size; i++) angle_rad[i] = angle[i]*DTOR; 
+  // Electron energy above threshold and corresponding number of Cherenkov photons produced
+  unsigned int first = FirstAboveThreshold(delta);
+  unsigned int size = fEe.size()-first;
+  // Too few electrons above threshold (high altitude)
+  if( size < 4 ) return 0.;
 
-  // Parametrization from Neirling et al. (2006)
-  double a0 = 0.42489, a1 = 0.58371, a2 = -0.082373;
-  double a = a0+a1*age+a2*pow(age,2);
+  for(unsigned int j = 0; j < size; j++) fSc[j] = Se[first+j]*fYield.Yield(fEe[first+j],delta,density);
 
-  double b0 = 0.055108, b1 = -0.095587, b2 = 0.056952;
-  double b = b0+b1*age+b2*pow(age,2);
+  return Integrate_nc5(size,&fSc[0],fLogEe[first+1]-fLogEe[first]);
+}
 
-  double Eth = EnergyThreshold(delta);
-  double theta_c = 0.62694*pow(Eth,-0.60590);
-  double theta_cc = (10.509-4.9644*age)*theta_c;
 
-  vector<double> distribution(size);
-  for(unsigned int i = 0; i < size; i++) distribution[i] = a*(1./theta_c)*exp(-angle_rad[i]/theta_c)+b*(1./theta_cc)*exp(-angle_rad[i]/theta_cc);
 
-  // Normalization
-  double norm = Integrate_nc5(angle_rad,distribution);
-  for(unsigned int i = 0; i < size; i++) distribution[i] = distribution[i]*DTOR/norm;
+vector<double> TCherenkov::AngularDistribution(vector<double> & angle, double age, double delta)
+{
+  vector<double> distribution(angle.size());
+  if( !angle.empty() ) AngularDistribution(angle.size(),&angle[0],age,delta,&distribution[0]);
 
   return distribution;
 }
 
 
 
+void TCherenkov::AngularDistribution(unsigned int size, const double * angle, double age, double delta, double * distribution)
+{
+  // Parametrization from Neirling et al. (2006), normalized over [0,180] degrees
+  TAngularDistribution(age,delta).Density(size,angle,distribution);
+}
+
+
+
 double * CherenkovEnergyThreshold(unsigned int size, const double * delta)
 {
   double * Eth = new double[size];
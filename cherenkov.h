@@ -1,8 +1,16 @@
 #ifndef _CHERENKOV_H
 #define _CHERENKOV_H
 
+#include "angular.h"
 #include "atmosphere.h"
+#include "common.h"
+#include "geometry.h"
+#include "matrix.h"
 #include "shower.h"
+#include "yield.h"
+#include "table.h"
+#include "transmission.h"
+#include "workspace.h"
 
 #include <vector>
 
@@ -10,42 +18,271 @@ using namespace std;
 
 
 
+/*!
+  Observables of every step of a shower, or of a batch of showers (depth major: step i of shower s at index
+  i*fNumberOfShowers+s), computed in a single pass by TCherenkov::ComputeProfile
+ */
+class TCherenkovProfile
+{
+  public :
+    //! Constructor
+    TCherenkovProfile() : fNumberOfShowers(0) {}
+
+    //! Number of showers
+    unsigned int fNumberOfShowers;
+
+    //! Number of radiation length
+    vector<double> fT;
+
+    //! Number of electrons/positrons
+    vector<double> fNe;
+
+    //! Shower age
+    vector<double> fAge;
+
+    //! Altitude in km
+    vector<double> fAltitude;
+
+    //! Air density in \f$ g . cm^{-3} \f$
+    vector<double> fDensity;
+
+    //! Index of refraction minus one
+    vector<double> fDelta;
+
+    //! Cherenkov energy threshold of electrons in MeV
+    vector<double> fEnergyThreshold;
+
+    //! Number of Cherenkov photons produced per \f$ g . cm^{-2} \f$
+    vector<double> fNc;
+
+    //! Angular distribution of the Cherenkov photons produced
+    vector<TAngularDistribution> fAngularDistribution;
+
+    //! Fraction of the photons reaching the ground (empty without TCherenkov::SetTransmission)
+    vector<double> fTransmission;
+};
+
+
+
 class TCherenkov
 {
   public :
     //! Constructor
     TCherenkov(const vector<TAtmosphere> & atmosphere, TShower * shower, double waveMin, double waveMax);
 
-    //! Destructor
+    //! Constructor with a wavelength efficiency tabulated in (wave, efficiency), wave in cm
+    TCherenkov(const vector<TAtmosphere> & atmosphere, TShower * shower, double waveMin, double waveMax,
+               const vector<double> & wave, const vector<double> & efficiency);
+
+    //! Constructor for batches of showers only (see the vector<TShower *> methods)
+    TCherenkov(const vector<TAtmosphere> & atmosphere, double waveMin, double waveMax);
+
+    //! Constructor sharing a read-only atmosphere. Showers are bound with #SetShower or given in batches.
+    TCherenkov(TAtmosphereHandle atmosphere, double waveMin, double waveMax);
+
+    //! Same as above with a wavelength efficiency tabulated in (wave, efficiency), wave in cm
+    TCherenkov(TAtmosphereHandle atmosphere, double waveMin, double waveMax, const vector<double> & wave, const vector<double> & efficiency);
+
+    //! Destructor. Deletes the shower given to the constructor, if any.
     ~TCherenkov();
 
+    /*!
+      Binds a generated shower, which is not owned by TCherenkov, to the single shower methods. Nothing else is
+      recomputed so one TCherenkov can process successive showers. A shower given to the constructor is deleted,
+      unless it is bound again.
+     */
+    void SetShower(TShower * shower);
+
+    //! Returns #fShower
+    TShower * GetShower() const {return fShower;}
+
     //! Total number of Cherenkov photons produced
     void ComputeTotalNumberPhotons(vector<double> & T, vector<double> & Nc);
     
     //! Normalized angular distribution with respect to shower axis
     void ComputeAngularDistribution(vector<double> & T, vector<double> & angle, vector<vector<double> > & distribution);
 
+    //! Normalized angular distribution with respect to shower axis, distribution(i,j) at depth T[i] and angle[j]
+    void ComputeAngularDistribution(vector<double> & T, vector<double> & angle, TMatrix2D & distribution);
+
+    //! Angular distribution at each depth T[i], to be evaluated at any angle (nothing is tabulated)
+    void ComputeAngularDistribution(vector<double> & T, vector<TAngularDistribution> & distribution);
+
+    /*!
+      Number of Cherenkov photons, angular distribution and intermediate parameters of every step, computed in one
+      pass. This is cheaper than calling #ComputeTotalNumberPhotons and #ComputeAngularDistribution one after the other.
+     */
+    void ComputeProfile(TCherenkovProfile & profile);
+
+    //! Same as above for a batch of showers (see TCherenkovProfile)
+    void ComputeProfile(const vector<TShower *> & showers, TCherenkovProfile & profile);
+
+    /*!
+      Total number of Cherenkov photons produced by a batch of generated showers with the same number of steps.
+      Nc[i*showers.size()+s] is the number of photons at depth T[i] for showers[s] (depth major). The showers are not
+      owned by TCherenkov. Temporaries are taken from the workspace of the calling thread (see TWorkspace).
+     */
+    void ComputeTotalNumberPhotons(const vector<TShower *> & showers, vector<double> & T, vector<double> & Nc);
+
+    /*!
+      Normalized angular distribution with respect to shower axis for a batch of showers (see above).
+      distribution[(i*showers.size()+s)*angle.size()+j] is the distribution at depth T[i] and angle[j] for showers[s].
+     */
+    void ComputeAngularDistribution(const vector<TShower *> & showers, vector<double> & T, vector<double> & angle, vector<double> & distribution);
+
+    //! Same as above with distribution(i*showers.size()+s,j) at depth T[i] and angle[j] for showers[s]
+    void ComputeAngularDistribution(const vector<TShower *> & showers, vector<double> & T, vector<double> & angle, TMatrix2D & distribution);
+
+    //! Angular distribution at each depth of a batch of showers, distribution[i*showers.size()+s] at T[i] for showers[s]
+    void ComputeAngularDistribution(const vector<TShower *> & showers, vector<double> & T, vector<TAngularDistribution> & distribution);
+
+    /*!
+      Converts slant depth to altitude in a curved atmosphere (see TSlantGeometry) instead of the flat-earth
+      depth2altitude(X cos(theta)), which breaks down for inclined showers. The geometries of the most recently
+      used zenith angles are cached and shared by all showers (see GetSlantGeometry).
+     */
+    void UseCurvedGeometry(bool curved = true) {fCurvedGeometry = curved;}
+
+    /*!
+      Atmospheric transmission from each step down to the ground, filled in TCherenkovProfile::fTransmission by
+      #ComputeProfile (band average looked up at the altitude of the step and the zenith angle of the shower). The
+      number of photons produced is unchanged. An empty handle removes the transmission.
+     */
+    void SetTransmission(TTransmissionHandle transmission);
+
+    //! Returns #fTransmission
+    TTransmissionHandle GetTransmission() const {return fTransmission;}
+
+    /*!
+      Prepares the spectral mode (#ComputeSpectrum) with nBins wavelength bins of equal width over the band and the
+      dispersion of Edlen for the index of refraction (see TSpectralYield). The spectral weights are computed here once.
+     */
+    void SetSpectralBinning(unsigned int nBins);
+
+    //! Same as above with the dispersion tabulated as the ratio delta(wave)/delta(400 nm) in (wave, ratio), wave in cm
+    void SetSpectralBinning(unsigned int nBins, const vector<double> & wave, const vector<double> & ratio);
+
+    /*!
+      Number of Cherenkov photons produced per \f$ g . cm^{-2} \f$ in each wavelength bin, photons(i,k) at depth
+      T[i] in the bin centered on wave[k] (in cm). Summed over the bins, it is the total number of photons of
+      #ComputeTotalNumberPhotons up to the dispersion and the discretization of the energy threshold.
+     */
+    void ComputeSpectrum(vector<double> & T, vector<double> & wave, TMatrix2D & photons);
+
+    //! Same as above for a batch of showers, photons(i*showers.size()+s,k) at depth T[i] for showers[s]
+    void ComputeSpectrum(const vector<TShower *> & showers, vector<double> & T, vector<double> & wave, TMatrix2D & photons);
+
+    /*!
+      Tabulates the number of Cherenkov photons produced per electron/positron and per \f$ g . cm^{-2} \f$ over
+      nAge shower ages in [0,3] and nAltitude altitudes spanning the atmosphere. #ComputeTotalNumberPhotons then
+      interpolates the table instead of integrating over the electron energy spectrum at every step. Steps outside
+      of the table are still computed exactly.
+     */
+    void BuildPhotonTable(unsigned int nAge = 301, unsigned int nAltitude = 481);
+
+    //! Writes the table built by #BuildPhotonTable in a binary file
+    bool SavePhotonTable(string fileName) const;
+
+    //! Memory-maps a table written by #SavePhotonTable. Fails if it does not match the atmosphere and the wavelength band.
+    bool LoadPhotonTable(string fileName);
+
   private :
-    //! Atmosphere
-    vector<TAtmosphere> fAtmosphere;
+    //! Not copyable
+    TCherenkov(const TCherenkov &);
+
+    //! Not assignable
+    TCherenkov & operator=(const TCherenkov &);
+
+    //! Initializes #fOwnShower, #fEe, #fLogEe, #fSc, #fPhotonTable, #fSpectralYield and #fCurvedGeometry
+    void Init();
+
+    //! Longitudinal profile, age, altitude, density and delta of every step of every shower of a batch (depth major), and zenith angle of every shower
+    struct TStepParameters
+    {
+      unsigned int fSize;
+      double * fNe;
+      double * fAge;
+      double * fAltitude;
+      double * fDensity;
+      double * fDelta;
+      double * fZenith; // per shower, in degrees
+    };
+
+    //! Computes the parameters of the steps of the size_batch showers, held in frame, on their shared depth grid (copied in T)
+    void ComputeStepParameters(unsigned int size_batch, TShower * const * showers, vector<double> & T,
+                               TWorkspaceFrame & frame, TStepParameters & step);
+
+    //! Total number of Cherenkov photons produced at each step, written in Nc
+    void ComputeTotalNumberPhotons(const TStepParameters & step, TWorkspaceFrame & frame, double * Nc);
+
+    //! Copies the step parameters in profile and computes the number of photons and the angular distributions
+    void ComputeProfile(unsigned int size_batch, const TStepParameters & step, TWorkspaceFrame & frame, TCherenkovProfile & profile);
+
+    //! Normalized angular distribution at each step, written in distribution
+    void ComputeAngularDistribution(const TStepParameters & step, vector<double> & angle, double * distribution);
+
+    //! Number of photons produced in each wavelength bin at each step, written in photons (step major)
+    void ComputeSpectrum(const TStepParameters & step, TWorkspaceFrame & frame, double * photons);
+
+    //! Identification of the atmosphere and the wavelength band saved along with #fPhotonTable
+    void PhotonTableKey(double * key) const;
+
+    //! Atmosphere, shared read-only
+    TAtmosphereHandle fAtmosphere;
 
     //! Shower
     TShower * fShower;
 
+    //! Tells you whether #fShower is deleted by TCherenkov or not
+    bool fOwnShower;
+
     //! Minimum wavelength of Cherenkov photons produced
     double fWaveMin;
     
     //! Maximum wavelength of Cherenkov photons produced
     double fWaveMax;
+
+    //! Cherenkov yield in [#fWaveMin, #fWaveMax]
+    TCherenkovYield fYield;
+
+    //! Electrons energy in MeV
+    vector<double> fEe;
+
+    //! Logarithm of #fEe
+    vector<double> fLogEe;
+
+    //! Scratch integrand of #NormalizedNumberPhotons
+    vector<double> fSc;
+
+    //! Tabulated number of Cherenkov photons produced per electron/positron (age, altitude)
+    TTable2D * fPhotonTable;
+
+    //! Tells you whether slant depths are converted in a curved atmosphere or not
+    bool fCurvedGeometry;
+
+    //! Slant geometries of the showers of a batch, a member so that the handles are not allocated at each batch
+    vector<TSlantGeometryHandle> fGeometry;
+
+    //! Atmospheric transmission tables, shared read-only (may be empty)
+    TTransmissionHandle fTransmission;
+
+    //! Spectral weights of #ComputeSpectrum
+    TSpectralYield * fSpectralYield;
     
     //! Energy threshold condition for Cherenkov in air (in MeV)
     double EnergyThreshold(double delta);
 
-    //! Number of Cherenkov photons produced by a electron/positron 
-    double Yield(double energy, double delta, double density);
+    //! Index of the first energy of #fEe above the Cherenkov threshold
+    unsigned int FirstAboveThreshold(double delta);
+
+    //! Number of Cherenkov photons produced per electron/positron and per g . cm^{-2} for the electron energy spectrum Se on #fEe
+    double NormalizedNumberPhotons(const double * Se, double delta, double density);
 
     //! Normalized angular distribution of produced Cherenkov photons
     vector<double> AngularDistribution(vector<double> & angle, double age, double delta);
+
+    //! Same as above at the size angles, written in distribution
+    void AngularDistribution(unsigned int size, const double * angle, double age, double delta, double * distribution);
 };
 
 //! Energy threshold condition for Cherenkov radiation in air (in MeV)
@@ -85,59 +85,27 @@ void SetPlotAttributes(TH1F * Histo, string name, string Xaxis)
 vector<double> Bins(unsigned int size,double min,double max,bool logarithmic)
 {
   vector<double> bins(size);
-  vector<double> array(size);
-  for(unsigned int i = 0; i < size; i++) array[i] = i/(size-1.);
-  if( !logarithmic ) for(unsigned int i = 0; i < size; i++) bins[i] = min+(max-min)*array[i];
-  else for(unsigned int i = 0; i < size; i++) bins[i] = pow(10,log10(min)+(log10(max)-log10(min))*array[i]);
+  if( size > 0 ) Bins(size,min,max,logarithmic,&bins[0]);
 
   return bins;
 }
 
 
 
+void Bins(unsigned int size, double min, double max, bool logarithmic, double * bins)
+{
+  if( !logarithmic ) for(unsigned int i = 0; i < size; i++) bins[i] = min+(max-min)*(i/(size-1.));
+  else for(unsigned int i = 0; i < size; i++) bins[i] = pow(10,log10(min)+(log10(max)-log10(min))*(i/(size-1.)));
+}
+
+
+
 double Integrate_nc5(const vector<double> & x, const vector<double> & y)
 {
   // This is a five points Newton-Cotes (Bode's formula) integrator
   // See NumRec for details
   // We assume that the data is regularly gridded
-  unsigned int npts = x.size();
-  double h = x[1]-x[0];
-  vector<unsigned int> ii; 
-  unsigned int nbii = (unsigned int)floor((npts-1.)/4);
-  unsigned int rest = (npts-1)-nbii*4;  
-  unsigned int nbii2;
-  if(rest == 1 || rest == 2) nbii2 = nbii-1;
-  else nbii2 = nbii;
-  ii.resize(nbii2);
-  for(unsigned int i = 0; i < nbii2; i++) ii[i] = (i+1)*4;
-
-  double integral = 0;
-  for(unsigned int i = 0; i < nbii2; i++) integral += 2.*h*(7.*(y[ii[i]-4]+y[ii[i]])+32.*(y[ii[i]-3]+y[ii[i]-1])+12.*y[ii[i]-2])/45.;
-
-  if( rest+1 == 2 ) 
-  {
-    // decoupage 4-3
-    unsigned int shift = npts-2;
-    // 4 points
-    integral += 3*h*(y[shift-4]+3*y[shift-3]+3*y[shift-2]+y[shift-1])/8.;
-    // 3 points
-    integral += h*(y[npts-3]+4*y[npts-2]+y[npts-1])/3.;
-  }
-  else if( rest+1 == 3 )
-  {
-    // decoupage 4-4
-    unsigned int shift = npts-3;
-    // 4 points
-    integral += 3*h*(y[shift-4]+3*y[shift-3]+3*y[shift-2]+y[shift-1])/8.;
-    // 3 points
-    shift = npts;
-    integral += 3*h*(y[shift-4]+3*y[shift-3]+3*y[shift-2]+y[shift-1])/8.;
-  }
-  else if(rest+1 == 4)
-  {
-    integral += 3*h*(y[npts-4]+3*y[npts-3]+3*y[npts-2]+y[npts-1])/8.;
-  }
-  return integral;
+  return Integrate_nc5(x.size(),&y[0],x[1]-x[0]);
 }
 
 
@@ -145,33 +113,91 @@ double Integrate_nc5(const vector<double> & x, const vector<double> & y)
 vector<double> Interpol(const vector<double>& x, const vector<double>& y, const vector<double>& u)
 {
   unsigned int size = u.size();
-  unsigned int xsize = x.size();
   vector<double> v(size);
+  if( !u.empty() ) Interpol(x,y,size,&u[0],&v[0]);
+
+  return v;
+}
+
+
+
+void Interpol(const vector<double> & x, const vector<double> & y, unsigned int size, const double * u, double * v)
+{
+  for(unsigned int i = 0; i < size; i++) v[i] = Interpol(x,y,u[i]);
+}
+
+
+double Interpol(const vector<double>& x, const vector<double>& y, double u)
+{
   unsigned int k, klow, khigh;
-  for( unsigned int i=0;i<size;i++ )
+  klow = 0;
+  khigh = x.size()-1;
+  while(khigh-klow>1)
   {   
-    klow = 0;
-    khigh = xsize-1;
-    while(khigh-klow>1)
-    {   
-      k = (khigh+klow)/2.;
-      if( x[k]>u[i] ) khigh = k;
-      else klow = k;
-    }   
-    v[i] = y[klow]+((y[klow]-y[khigh])/(x[klow]-x[khigh]))*(u[i]-x[klow]);
+    k = (khigh+klow)/2.;
+    if( x[k]>u ) khigh = k;
+    else klow = k;
   }   
 
-  return v;
+  return y[klow]+((y[klow]-y[khigh])/(x[klow]-x[khigh]))*(u-x[klow]);
 }
 
 
-double Interpol(const vector<double>& x, const vector<double>& y, double u)
+
+TInterpolator::TInterpolator(const vector<double> & x, const vector<double> & y)
 {
-  vector<double> v(1);
-  vector<double> uu(1);
-  uu[0] = u;
-  v = Interpol(x,y,uu);
+  fX = x;
+  fY = y;
+  unsigned int size = fX.size();
+  if( size < 2 || fY.size() != size ) {cout << "ERROR: at least two tabulated points are required. EXITING." << endl; exit(0);}
+
+  fSlope.resize(size-1);
+  for(unsigned int k = 0; k < size-1; k++) fSlope[k] = (fY[k]-fY[k+1])/(fX[k]-fX[k+1]);
+
+  // Uniform grid: the interval is given by the position of the point
+  double step = (fX[size-1]-fX[0])/(size-1.);
+  fUniform = true;
+  for(unsigned int k = 1; k < size && fUniform; k++) if( fabs(fX[k]-(fX[0]+k*step)) > 1.e-9*step ) fUniform = false;
+  if( fUniform )
+    {
+      fInvStep = 1./step;
+      fIndex.resize(size-1);
+      return;
+    }
+
+  // Non uniform grid: uniform index of the first interval of each step, four times finer than the mean step
+  unsigned int size_index = 4*(size-1);
+  fInvStep = size_index/(fX[size-1]-fX[0]);
+  fIndex.resize(size_index);
+  unsigned int k = 0;
+  for(unsigned int i = 0; i < size_index; i++)
+    {
+      double u = fX[0]+i/fInvStep;
+      while( k < size-2 && fX[k+1] <= u ) k++;
+      fIndex[i] = k;
+    }
+}
+
+
 
-  return v[0];
+void TInterpolator::Eval(unsigned int size, const double * u, double * v) const
+{
+  unsigned int k = 0;
+  for(unsigned int i = 0; i < size; i++)
+    {
+      // Increasing points: walk from the previous interval
+      if( i > 0 && u[i] >= u[i-1] ) k = Adjust(k,u[i]);
+      else k = Locate(u[i]);
+      v[i] = fY[k]+fSlope[k]*(u[i]-fX[k]);
+    }
 }
 
+
+
+vector<double> TInterpolator::Eval(const vector<double> & u) const
+{
+  vector<double> v(u.size());
+  if( !u.empty() ) Eval(u.size(),&u[0],&v[0]);
+
+  return v;
+}
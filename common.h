@@ -77,12 +77,38 @@ void SetPlotAttributes(TH1F * Histo, string name, string Xaxis);
 //! Binning
 vector<double> Bins(unsigned int size, double min, double max, bool logarithmic = false);
 
+//! Binning written in the size values of bins
+void Bins(unsigned int size, double min, double max, bool logarithmic, double * bins);
+
 /*! 
   This is a simple 5 points Newton-Cotes formula that allows numerical integration of the function given by x 
   and y. This (simple) algorithm requires the x values to be equally spaced and in increasing order. It is very 
   accurate as long as the function is well sampled (see Numerical Recipes in C for details).
  */
-double Integrate_nc5(const vector<double> & x, const vector<double> & y); 
+double Integrate_nc5(const vector<double> & x, const vector<double> & y);
+
+/*!
+  Same 5 points Newton-Cotes formula for the size values y equally spaced by h, without any allocation. Below 4
+  points, the Simpson (3 points) or trapezoidal (2 points) rules are used.
+ */
+template <typename Real> Real Integrate_nc5(unsigned int size, const Real * y, Real h);
+
+//! Weights w of the size points such that Integrate_nc5(size, y, h) is the sum of the w[i]*y[i]
+template <typename Real> void Weights_nc5(unsigned int size, Real h, Real * w);
+
+/*!
+  Integrates the rows of a matrix in one call with the weights w given by #Weights_nc5. Row r holds the size values
+  y[r*stride+j] and its integral is written in integral[r]. Each row is a dot product split in four partial sums,
+  which the compiler vectorizes (-O2 and above).
+ */
+template <typename Real> void Integrate_nc5(unsigned int rows, unsigned int size, const Real * y, unsigned int stride, const Real * w, Real * integral);
+
+/*!
+  Running integral of the size values y equally spaced by h: integral[i] is the integral from the first point up to
+  the i-th one (integral[0] = 0). Each interval is integrated with the 4 points Lagrange formula, which is of the same
+  order as #Integrate_nc5 for smooth functions.
+ */
+template <typename Real> void CumulativeIntegrate(unsigned int size, const Real * y, Real h, Real * integral);
 
 /* 
    Given the vectors x and y, wich tabulate a function (with the x's in order), this routine returns a linear
@@ -96,5 +122,184 @@ vector<double> Interpol(const vector<double> & x, const vector<double> & y, cons
  */
 double Interpol(const vector<double> & x, const vector<double> & y, double u);
 
+//! Same as above at the size points u, written in v
+void Interpol(const vector<double> & x, const vector<double> & y, unsigned int size, const double * u, double * v);
+
+/*!
+  Linear interpolation of the function tabulated in (x, y), with the x's in increasing order, built once and
+  evaluated many times. The slopes are precomputed. The interval holding a point is found by direct indexing on
+  a uniform grid, and through a uniform index of the grid otherwise. Arrays of increasing points are processed in
+  a single walk along the table. Results are identical to Interpol, including the linear extrapolation outside of
+  the table.
+ */
+class TInterpolator
+{
+  public :
+    //! Constructor of an empty interpolator
+    TInterpolator() {}
+
+    //! Constructor
+    TInterpolator(const vector<double> & x, const vector<double> & y);
+
+    //! Linear interpolation at point u
+    double Eval(double u) const {unsigned int k = Locate(u); return fY[k]+fSlope[k]*(u-fX[k]);}
+
+    //! Linear interpolation at the size points u, written in v
+    void Eval(unsigned int size, const double * u, double * v) const;
+
+    //! Linear interpolation at points u
+    vector<double> Eval(const vector<double> & u) const;
+
+  private :
+    //! Index k of the interval [x[k], x[k+1]] holding u, or of the first/last interval outside of the table
+    unsigned int Locate(double u) const
+    {
+      double position = (u-fX.front())*fInvStep;
+      unsigned int k = 0;
+      if( position > 0. ) k = position < fIndex.size() ? (fUniform ? (unsigned int) position : fIndex[(unsigned int) position]) : fSlope.size()-1;
+      return Adjust(k,u);
+    }
+
+    //! Moves k to the interval holding u
+    unsigned int Adjust(unsigned int k, double u) const
+    {
+      unsigned int last = fSlope.size()-1;
+      if( k > last ) k = last;
+      while( k > 0 && fX[k] > u ) k--;
+      while( k < last && fX[k+1] <= u ) k++;
+      return k;
+    }
+
+    //! Tabulated x values
+    vector<double> fX;
+
+    //! Tabulated y values
+    vector<double> fY;
+
+    //! Slope of each interval
+    vector<double> fSlope;
+
+    //! Tells you whether the x values are equally spaced or not
+    bool fUniform;
+
+    //! Inverse of the step of the index
+    double fInvStep;
+
+    //! First interval of each step of the index (its size only when #fUniform)
+    vector<unsigned int> fIndex;
+};
+
+
+
+template <typename Real> Real Integrate_nc5(unsigned int size, const Real * y, Real h)
+{
+  if( size < 2 ) return 0.;
+  if( size == 2 ) return h*(y[0]+y[1])/2.;
+  if( size == 3 ) return h*(y[0]+4*y[1]+y[2])/3.;
+
+  // Bode's formula over blocks of 5 points, closed with 3/8 and Simpson rules (see the vector version)
+  unsigned int nbii = (size-1)/4;
+  unsigned int rest = (size-1)-nbii*4;
+  unsigned int nbii2 = (rest == 1 || rest == 2) ? nbii-1 : nbii;
+
+  Real integral = 0;
+  for(unsigned int a = 4; a <= 4*nbii2; a += 4) integral += 2.*h*(7.*(y[a-4]+y[a])+32.*(y[a-3]+y[a-1])+12.*y[a-2])/45.;
+
+  if( rest+1 == 2 )
+  {
+    unsigned int shift = size-2;
+    integral += 3*h*(y[shift-4]+3*y[shift-3]+3*y[shift-2]+y[shift-1])/8.;
+    integral += h*(y[size-3]+4*y[size-2]+y[size-1])/3.;
+  }
+  else if( rest+1 == 3 )
+  {
+    unsigned int shift = size-3;
+    integral += 3*h*(y[shift-4]+3*y[shift-3]+3*y[shift-2]+y[shift-1])/8.;
+    shift = size;
+    integral += 3*h*(y[shift-4]+3*y[shift-3]+3*y[shift-2]+y[shift-1])/8.;
+  }
+  else if( rest+1 == 4 )
+  {
+    integral += 3*h*(y[size-4]+3*y[size-3]+3*y[size-2]+y[size-1])/8.;
+  }
+  return integral;
+}
+
+
+
+template <typename Real> void Weights_nc5(unsigned int size, Real h, Real * w)
+{
+  for(unsigned int i = 0; i < size; i++) w[i] = 0.;
+  if( size < 2 ) return;
+  if( size == 2 ) {w[0] += h/2.; w[1] += h/2.; return;}
+  if( size == 3 ) {w[0] += h/3.; w[1] += 4*h/3.; w[2] += h/3.; return;}
+
+  const Real bode[5] = {14., 64., 24., 64., 14.};
+  const Real rule38[4] = {3., 9., 9., 3.};
+  unsigned int nbii = (size-1)/4;
+  unsigned int rest = (size-1)-nbii*4;
+  unsigned int nbii2 = (rest == 1 || rest == 2) ? nbii-1 : nbii;
+
+  for(unsigned int a = 4; a <= 4*nbii2; a += 4)
+    for(unsigned int k = 0; k < 5; k++) w[a-4+k] += bode[k]*h/45.;
+
+  if( rest+1 == 2 )
+  {
+    for(unsigned int k = 0; k < 4; k++) w[size-6+k] += rule38[k]*h/8.;
+    w[size-3] += h/3.; w[size-2] += 4*h/3.; w[size-1] += h/3.;
+  }
+  else if( rest+1 == 3 )
+  {
+    for(unsigned int k = 0; k < 4; k++) w[size-7+k] += rule38[k]*h/8.;
+    for(unsigned int k = 0; k < 4; k++) w[size-4+k] += rule38[k]*h/8.;
+  }
+  else if( rest+1 == 4 )
+  {
+    for(unsigned int k = 0; k < 4; k++) w[size-4+k] += rule38[k]*h/8.;
+  }
+}
+
+
+
+template <typename Real> void Integrate_nc5(unsigned int rows, unsigned int size, const Real * y, unsigned int stride, const Real * w, Real * integral)
+{
+  // Blocks of 4 points first, the remaining points in a second pass (a single inner loop is vectorized)
+  unsigned int blocks = size-size%4;
+  for(unsigned int r = 0; r < rows; r++)
+    {
+      const Real * row = y+(size_t)r*stride;
+      Real sum0 = 0., sum1 = 0., sum2 = 0., sum3 = 0.;
+      for(unsigned int j = 0; j < blocks; j += 4)
+        {
+          sum0 += w[j]*row[j];
+          sum1 += w[j+1]*row[j+1];
+          sum2 += w[j+2]*row[j+2];
+          sum3 += w[j+3]*row[j+3];
+        }
+      integral[r] = (sum0+sum1)+(sum2+sum3);
+    }
+  for(unsigned int r = 0; r < rows; r++)
+    for(unsigned int j = blocks; j < size; j++) integral[r] += w[j]*y[(size_t)r*stride+j];
+}
+
+
+
+template <typename Real> void CumulativeIntegrate(unsigned int size, const Real * y, Real h, Real * integral)
+{
+  if( size == 0 ) return;
+  integral[0] = 0.;
+  if( size < 4 )
+    {
+      // Trapezoidal rule
+      for(unsigned int i = 1; i < size; i++) integral[i] = integral[i-1]+h*(y[i-1]+y[i])/2.;
+      return;
+    }
+
+  // First and last intervals with one-sided formulas, interior ones with the centered formula
+  integral[1] = h*(9*y[0]+19*y[1]-5*y[2]+y[3])/24.;
+  for(unsigned int i = 1; i+2 < size; i++) integral[i+1] = integral[i]+h*(13*(y[i]+y[i+1])-(y[i-1]+y[i+2]))/24.;
+  integral[size-1] = integral[size-2]+h*(y[size-4]-5*y[size-3]+19*y[size-2]+9*y[size-1])/24.;
+}
+
 
 #endif
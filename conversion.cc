@@ -9,13 +9,20 @@ vector<double> age2depth(const vector<double> & age, double Xmax)
 {
   unsigned int size = age.size();
   vector<double> X(size);
-  for(unsigned int i = 0; i < size; i++) X[i] = 2.*Xmax*1./(3./age[i]-1.);
+  if( !age.empty() ) age2depth(size,&age[0],Xmax,&X[0]);
 
   return X; 
 }
 
 
 
+void age2depth(unsigned int size, const double * age, double Xmax, double * X)
+{
+  for(unsigned int i = 0; i < size; i++) X[i] = 2.*Xmax*1./(3./age[i]-1.);
+}
+
+
+
 double age2depth(double age, double Xmax)
 {
   double X = 2.*Xmax*1./(3./age-1.);
@@ -29,13 +36,20 @@ vector<double> depth2age(const vector<double> & X, double Xmax)
 {
   unsigned int size = X.size();
   vector<double> age(size);
-  for(unsigned int i = 0; i < size; i++) age[i] = 3./(1.+2.*Xmax/X[i]);
+  if( !X.empty() ) depth2age(size,&X[0],Xmax,&age[0]);
 
   return age;
 }
 
 
 
+void depth2age(unsigned int size, const double * X, double Xmax, double * age)
+{
+  for(unsigned int i = 0; i < size; i++) age[i] = 3./(1.+2.*Xmax/X[i]);
+}
+
+
+
 double depth2age(double X, double Xmax)
 {
   double age = 3./(1.+2.*Xmax/X);
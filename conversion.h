@@ -11,12 +11,18 @@ vector<double> age2depth(const vector<double> & age, double Xmax);
 //! Shower age to slant depth [\f$ g . cm^{-2} \f$] 
 double age2depth(double age, double Xmax);
 
+//! Shower age to slant depth [\f$ g . cm^{-2} \f$] for the size values of age, written in X
+void age2depth(unsigned int size, const double * age, double Xmax, double * X);
+
 //! Slant depth [\f$ g . cm^{-2} \f$] to shower age
 vector<double> depth2age(const vector<double> & X, double Xmax);
 
 //! Slant depth [\f$ g . cm^{-2} \f$] to shower age 
 double depth2age(double X, double Xmax);
 
+//! Slant depth [\f$ g . cm^{-2} \f$] to shower age for the size values of X, written in age
+void depth2age(unsigned int size, const double * X, double Xmax, double * age);
+
 //! Altitude [km] to depth [\f$ g . cm^{-2} \f$]
 double altitude2depth(double altitude);
 
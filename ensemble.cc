@@ -0,0 +1,99 @@
+#include "ensemble.h"
+#include "cherenkov.h"
+#include "results.h"
+#include "shower.h"
+
+#include <iostream>
+
+
+
+TEnsemble::TEnsemble(double energy, double * coord, unsigned int step)
+{
+  fEnergy = energy;
+  fCoord[0] = coord[0];
+  fCoord[1] = coord[1];
+  fStep = step;
+  fSeed = TRandomStream::GetRunSeed();
+  fFirstIndex = 0;
+  fCherenkov = false;
+  fCurvedGeometry = false;
+  fWaveMin = 0.;
+  fWaveMax = 0.;
+}
+
+
+
+void TEnsemble::SetCherenkov(const vector<TAtmosphere> & atmosphere, double waveMin, double waveMax)
+{
+  SetCherenkov(TAtmosphereHandle(new TAtmosphereProfile(atmosphere)),waveMin,waveMax);
+}
+
+
+
+void TEnsemble::SetCherenkov(TAtmosphereHandle atmosphere, double waveMin, double waveMax)
+{
+  fCherenkov = true;
+  fAtmosphere = atmosphere;
+  fWaveMin = waveMin; // in cm
+  fWaveMax = waveMax; // in cm
+}
+
+
+
+void TEnsemble::Run(unsigned int size, unsigned int nThreads)
+{
+  TThreadPool pool(nThreads);
+  Run(size,pool);
+}
+
+
+
+void TEnsemble::Run(unsigned int size, TThreadPool & pool)
+{
+  fShowers.clear();
+  fShowers.resize(size);
+  fFirstIndex = TRandomStream::NextIndex(size);
+
+  // One Cherenkov calculator per thread, built once and shared by all the showers of the thread
+  unsigned int nThreads = pool.GetNumberOfThreads();
+  vector<TCherenkov *> Cherenkov(nThreads,(TCherenkov *) 0);
+  if( fCherenkov )
+    {
+      for(unsigned int i = 0; i < nThreads; i++)
+        {
+          Cherenkov[i] = new TCherenkov(fAtmosphere,fWaveMin,fWaveMax);
+          Cherenkov[i]->UseCurvedGeometry(fCurvedGeometry);
+          if( !fPhotonTable.empty() && !Cherenkov[i]->LoadPhotonTable(fPhotonTable) ) {cout << "Cannot use " << fPhotonTable << ". EXITING." << endl; exit(0);}
+        }
+    }
+
+  pool.ParallelFor(size,[&](unsigned int index, unsigned int thread)
+    {
+      TShower Shower(fEnergy,fCoord,fStep,fSeed,fFirstIndex+index);
+      Shower.GenerateShower();
+
+      TEnsembleShower & result = fShowers[index];
+      result.fT1 = Shower.GetT1();
+      result.fTmax = Shower.GetTmax();
+      result.fNe = Shower.GetNumberOfElectrons();
+      if( Cherenkov[thread] )
+        {
+          vector<double> T;
+          Cherenkov[thread]->ComputeTotalNumberPhotons(vector<TShower *>(1,&Shower),T,result.fNc);
+        }
+      if( index == 0 ) fT = Shower.GetDepth();
+    });
+
+  for(unsigned int i = 0; i < nThreads; i++) if( Cherenkov[i] ) delete Cherenkov[i];
+}
+
+
+
+bool TEnsemble::Save(string fileName) const
+{
+  TResultWriter writer(fileName,fT);
+  if( !writer.IsOpen() ) return false;
+  for(unsigned int i = 0; i < fShowers.size(); i++) writer.Fill(fEnergy,fCoord,fShowers[i]);
+
+  return writer.Close();
+}
@@ -0,0 +1,131 @@
+#ifndef _ENSEMBLE_H
+#define _ENSEMBLE_H
+
+#include <vector>
+#include <string>
+
+#include "atmosphere.h"
+#include "random.h"
+#include "threadpool.h"
+
+using namespace std;
+
+
+
+//! Characteristics of a shower of an ensemble
+class TEnsembleShower
+{
+  public :
+    //! Constructor
+    TEnsembleShower() {}
+
+    //! Depth of the first interaction in unit of radiation length
+    double fT1;
+
+    //! Depth at shower maximum in unit of radiation length
+    double fTmax;
+
+    //! Number of electrons/positrons
+    vector<double> fNe;
+
+    //! Total number of Cherenkov photons produced (empty unless #TEnsemble::SetCherenkov is called)
+    vector<double> fNc;
+};
+
+
+
+/*!
+  Generates an ensemble of showers of the same energy and incoming direction on all cores, and optionally computes
+  the Cherenkov photons they produce. Showers are distributed over a work-stealing thread pool and the results are
+  stored by shower number. Each #Run reserves a block of stream indices with TRandomStream::NextIndex, so showers of
+  different ensembles and single TShower never share a stream, and shower i draws its random numbers from stream
+  (#fSeed, #fFirstIndex+i): an ensemble is bit-identical whatever the number of threads and any of its showers can be
+  regenerated alone.
+ */
+class TEnsemble
+{
+  public :
+    //! Constructor
+    TEnsemble(double energy, double * coord, unsigned int step = 800);
+
+    //! Also computes the total number of Cherenkov photons produced between waveMin and waveMax (in cm)
+    void SetCherenkov(const vector<TAtmosphere> & atmosphere, double waveMin, double waveMax);
+
+    //! Same as above with a shared read-only atmosphere
+    void SetCherenkov(TAtmosphereHandle atmosphere, double waveMin, double waveMax);
+
+    //! Sets #fSeed. Shower i of an ensemble uses the random stream (#fSeed, #fFirstIndex+i).
+    void SetSeed(uint64_t seed) {fSeed = seed;}
+
+    //! Returns #fSeed
+    uint64_t GetSeed() const {return fSeed;}
+
+    //! Returns #fFirstIndex
+    uint64_t GetFirstIndex() const {return fFirstIndex;}
+
+    //! Converts slant depth to altitude in a curved atmosphere (see TCherenkov::UseCurvedGeometry)
+    void UseCurvedGeometry(bool curved = true) {fCurvedGeometry = curved;}
+
+    //! Interpolates the photon table written by TCherenkov::SavePhotonTable (see #SetCherenkov)
+    void SetPhotonTable(string fileName) {fPhotonTable = fileName;}
+
+    //! Generates size showers with nThreads threads (all hardware threads when nThreads = 0)
+    void Run(unsigned int size, unsigned int nThreads = 0);
+
+    //! Generates size showers with the threads of pool
+    void Run(unsigned int size, TThreadPool & pool);
+
+    //! Returns #fT
+    const vector<double> & GetDepth() const {return fT;}
+
+    //! Returns the number of showers generated by the last #Run
+    unsigned int GetSize() const {return fShowers.size();}
+
+    //! Returns shower i of the last #Run
+    const TEnsembleShower & GetShower(unsigned int i) const {return fShowers[i];}
+
+    //! Writes the showers of the last #Run in a columnar result file (see TResultWriter)
+    bool Save(string fileName) const;
+
+  private :
+    //! Energy in eV
+    double fEnergy;
+
+    //! Zenith and azimuth angles
+    double fCoord[2];
+
+    //! Step in radiation length
+    unsigned int fStep;
+
+    //! Run seed
+    uint64_t fSeed;
+
+    //! Stream index of shower 0 of the last #Run
+    uint64_t fFirstIndex;
+
+    //! Tells you whether the Cherenkov photons are computed or not
+    bool fCherenkov;
+
+    //! Atmosphere, shared by the Cherenkov calculators of all threads
+    TAtmosphereHandle fAtmosphere;
+
+    //! Minimum wavelength of Cherenkov photons produced
+    double fWaveMin;
+
+    //! Maximum wavelength of Cherenkov photons produced
+    double fWaveMax;
+
+    //! Tells you whether slant depths are converted in a curved atmosphere or not
+    bool fCurvedGeometry;
+
+    //! Photon table file, if any
+    string fPhotonTable;
+
+    //! Number of radiation length
+    vector<double> fT;
+
+    //! Showers
+    vector<TEnsembleShower> fShowers;
+};
+
+#endif
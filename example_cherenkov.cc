@@ -7,6 +7,7 @@
 #include "cherenkov.h"
 #include "shower.h"
 #include "conversion.h"
+#include "ensemble.h"
 
 #include <TObject.h>
 #include <TLatex.h>
@@ -59,33 +60,33 @@ int main(int argc, char* argv[])
   gROOT->SetStyle("Plain");
   gStyle->SetTitleFont(30,"TITLE");
 
-  // Atmosphere
-  vector<TAtmosphere> atmosphere = GetAtmosphere(AtmosphereFile);
+  // Atmosphere, shared read-only
+  TAtmosphereHandle atmosphere = GetAtmosphereProfile(AtmosphereFile);
 
   // Wavelength range for Cherenkov photons produced (in cm)
   double WaveMin = 300e-7, WaveMax = 400e-7;
 
   /* Let's go */
   unsigned int NumberOfShower = 20;
+  unsigned int step = 50;
 
-  vector<vector<double> > Nc(NumberOfShower);
+  // Angular distribution for a single shower
   vector<double> angle;
-  vector<vector<double> > AngularDistribution;
+  TMatrix2D AngularDistribution;
   vector<double> T;
-  double Tmax = 0;
-
-  for(unsigned int i = 0; i < NumberOfShower; i++)
-    {
-      cout << "Shower #" << i+1 << "/" << NumberOfShower << endl;
-      TShower * Shower = new TShower(energy,coord,50);
-      Shower->GenerateShower();
-      TCherenkov * Cherenkov = new TCherenkov(atmosphere,Shower,WaveMin,WaveMax);
-      if( i == 0 ) {Tmax = Shower->GetTmax(); Cherenkov->ComputeAngularDistribution(T,angle,AngularDistribution);}
-      vector<double> T_tmp, Nc_tmp;
-      Cherenkov->ComputeTotalNumberPhotons(T_tmp,Nc_tmp);
-      Nc[i].resize(T_tmp.size());
-      for(unsigned j = 0; j < T_tmp.size(); j++) Nc[i][j] = Nc_tmp[j];
-    }
+  TShower Shower(energy,coord,step);
+  Shower.GenerateShower();
+  double Tmax = Shower.GetTmax();
+  TCherenkov Cherenkov(atmosphere,WaveMin,WaveMax);
+  Cherenkov.SetShower(&Shower);
+  Cherenkov.ComputeAngularDistribution(T,angle,AngularDistribution);
+
+  // Total number of Cherenkov photons produced by an ensemble of showers, on all cores
+  TEnsemble Ensemble(energy,coord,step);
+  Ensemble.SetCherenkov(atmosphere,WaveMin,WaveMax);
+  Ensemble.Run(NumberOfShower);
+  vector<vector<double> > Nc(NumberOfShower);
+  for(unsigned int i = 0; i < NumberOfShower; i++) Nc[i] = Ensemble.GetShower(i).fNc;
 
   // Total number of Cherenkov photons produced
   TCanvas * cCherenkov = new TCanvas(GetObjName(),"Cherenkov",600,600);
@@ -140,7 +141,7 @@ int main(int argc, char* argv[])
         {
           if( depth2age(T[j],Tmax) > age[i] )
             {
-              for(unsigned int k = 0; k < angle.size(); k++) gAngularDistribution->SetPoint(k,angle[k],factor[i]*AngularDistribution[j][k]);
+              for(unsigned int k = 0; k < angle.size(); k++) gAngularDistribution->SetPoint(k,angle[k],factor[i]*AngularDistribution(j,k));
               break;
             }
         }
@@ -62,23 +62,26 @@ int main(int argc, char* argv[])
   vector< vector<double> > Ne_MC(keep);
   vector<double> T_MC;
 
+  // Depth of the first interaction, sampled without building the showers
+  uint64_t seed = TRandomStream::GetRunSeed();
+  vector<double> T1(NumberOfShower);
+  SampleShowerVariates(seed,0,NumberOfShower,&T1[0]);
   for(unsigned int i = 0; i < NumberOfShower; i++)
     {
-      TShower * Shower = new TShower(energy,coord);
-      double altitude = depth2altitude(Shower->GetT1()*X0);
+      double altitude = depth2altitude(T1[i]*X0);
       hFirstInteraction->Fill(altitude);
+    }
 
-      if( i < keep )
-        {
-          vector<double> T_tmp, Ne_tmp;
-          Shower->GenerateShower();
-          Shower->GetLongitudinalProfile(T_tmp,Ne_tmp);
-          Ne_MC[i].resize(T_tmp.size());
-          for(unsigned j = 0; j < T_tmp.size(); j++) Ne_MC[i][j] = Ne_tmp[j];
-          if( i == 0 ) T_MC = T_tmp;
-        }
-
-      delete Shower;
+  // Longitudinal profiles of the first showers of the sample
+  for(unsigned int i = 0; i < keep; i++)
+    {
+      vector<double> T_tmp, Ne_tmp;
+      TShower Shower(energy,coord,800,seed,i);
+      Shower.GenerateShower();
+      Shower.GetLongitudinalProfile(T_tmp,Ne_tmp);
+      Ne_MC[i].resize(T_tmp.size());
+      for(unsigned j = 0; j < T_tmp.size(); j++) Ne_MC[i][j] = Ne_tmp[j];
+      if( i == 0 ) T_MC = T_tmp;
     }
   SetPlotAttributes(hFirstInteraction,"","Altitude of first interaction [km]");
   hFirstInteraction->Draw("");
@@ -0,0 +1,135 @@
+#include "geometry.h"
+
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdint.h>
+
+using namespace kMathConstants;
+
+namespace
+{
+  //! Earth radius in km
+  const double kEarthRadius = 6371.;
+
+  //! Number of integration steps along the shower axis
+  const unsigned int kIntegrationSteps = 20000;
+
+  //! Number of tabulated slant depths
+  const unsigned int kTableSize = 4096;
+
+  //! Largest number of geometries kept by GetSlantGeometry
+  const unsigned int kCacheSize = 16;
+
+  //! Geometries of GetSlantGeometry by atmosphere and zenith angle
+  typedef pair<const TAtmosphereProfile *, double> TCacheKey;
+
+  //! Cached geometry, with a weak reference to its atmosphere to tell whether it is still alive and its last use
+  struct TCacheEntry
+  {
+    weak_ptr<const TAtmosphereProfile> fAtmosphere;
+    TSlantGeometryHandle fGeometry;
+    uint64_t fLastUse;
+  };
+}
+
+
+
+TSlantGeometry::TSlantGeometry(TAtmosphereHandle atmosphere, double theta)
+{
+  fTheta = theta;
+
+  // Distance s along the axis from the shower core up to the top of the atmosphere
+  double CosTheta = cos(theta*DTOR);
+  double top = atmosphere->GetAltitude().back();
+  double length = -kEarthRadius*CosTheta+sqrt(pow(kEarthRadius*CosTheta,2)+top*(top+2*kEarthRadius));
+
+  // Altitude h(s) and slant depth X(s) integrated from the top down (trapezoidal rule, km to cm)
+  vector<double> altitude(kIntegrationSteps+1), depth(kIntegrationSteps+1);
+  vector<double> s = Bins(kIntegrationSteps+1,length,0.);
+  for(unsigned int i = 0; i <= kIntegrationSteps; i++)
+    altitude[i] = sqrt(kEarthRadius*kEarthRadius+s[i]*s[i]+2*kEarthRadius*s[i]*CosTheta)-kEarthRadius;
+  altitude[kIntegrationSteps] = 0.;
+  vector<double> density(kIntegrationSteps+1);
+  atmosphere->GetDensity(kIntegrationSteps+1,&altitude[0],&density[0]);
+  for(unsigned int i = 0; i <= kIntegrationSteps; i++) if( density[i] < 0. ) density[i] = 0.;
+  double ds = 1.e5*length/kIntegrationSteps;
+  depth[0] = 0.;
+  for(unsigned int i = 1; i <= kIntegrationSteps; i++) depth[i] = depth[i-1]+0.5*ds*(density[i-1]+density[i]);
+  fGroundDepth = depth[kIntegrationSteps];
+
+  // Altitude on a uniform grid of slant depth
+  TInterpolator DepthToAltitude(depth,altitude);
+  vector<double> depth_table = Bins(kTableSize,0.,fGroundDepth);
+  fAltitude = TInterpolator(depth_table,DepthToAltitude.Eval(depth_table));
+
+  // Slant depth as a function of increasing altitude
+  vector<double> altitude_up(altitude.rbegin(),altitude.rend()), depth_up(depth.rbegin(),depth.rend());
+  fSlantDepth = TInterpolator(altitude_up,depth_up);
+}
+
+
+
+TSlantGeometryHandle GetSlantGeometry(TAtmosphereHandle atmosphere, double theta)
+{
+  TSlantGeometryHandle geometry;
+  GetSlantGeometry(atmosphere,1,&theta,&geometry);
+
+  return geometry;
+}
+
+
+
+void GetSlantGeometry(TAtmosphereHandle atmosphere, unsigned int size, const double * theta, TSlantGeometryHandle * geometry)
+{
+  static mutex CacheMutex;
+  static map<TCacheKey, TCacheEntry> Cache;
+  static uint64_t Clock = 0;
+
+  // Cached geometries
+  unsigned int missing = 0;
+  {
+    lock_guard<mutex> lock(CacheMutex);
+    for(unsigned int i = 0; i < size; i++)
+      {
+        geometry[i].reset();
+        map<TCacheKey, TCacheEntry>::iterator it = Cache.find(make_pair(atmosphere.get(),theta[i]));
+        if( it == Cache.end() || it->second.fAtmosphere.expired() ) {missing++; continue;}
+        it->second.fLastUse = ++Clock;
+        geometry[i] = it->second.fGeometry;
+      }
+  }
+  if( missing == 0 ) return;
+
+  // New geometries, built without holding the lock (once for zenith angles repeated in theta)
+  for(unsigned int i = 0; i < size; i++)
+    {
+      if( geometry[i] ) continue;
+      for(unsigned int j = 0; j < i && !geometry[i]; j++) if( theta[j] == theta[i] ) geometry[i] = geometry[j];
+      if( !geometry[i] ) geometry[i] = TSlantGeometryHandle(new TSlantGeometry(atmosphere,theta[i]));
+    }
+
+  lock_guard<mutex> lock(CacheMutex);
+  for(unsigned int i = 0; i < size; i++)
+    {
+      TCacheEntry & entry = Cache[make_pair(atmosphere.get(),theta[i])];
+      if( entry.fGeometry && !entry.fAtmosphere.expired() ) continue; // also built by another thread
+      entry.fAtmosphere = atmosphere;
+      entry.fGeometry = geometry[i];
+      entry.fLastUse = ++Clock;
+    }
+
+  // Drop the geometries of the deleted atmospheres (whose address may even be reused), then the least recently used ones
+  for(map<TCacheKey, TCacheEntry>::iterator it = Cache.begin(); it != Cache.end(); )
+    {
+      if( it->second.fAtmosphere.expired() ) Cache.erase(it++);
+      else ++it;
+    }
+  while( Cache.size() > kCacheSize )
+    {
+      map<TCacheKey, TCacheEntry>::iterator oldest = Cache.begin();
+      for(map<TCacheKey, TCacheEntry>::iterator it = Cache.begin(); it != Cache.end(); ++it)
+        if( it->second.fLastUse < oldest->second.fLastUse ) oldest = it;
+      Cache.erase(oldest);
+    }
+}
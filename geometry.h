@@ -0,0 +1,69 @@
+#ifndef _GEOMETRY_H
+#define _GEOMETRY_H
+
+#include <vector>
+#include <memory>
+
+#include "atmosphere.h"
+#include "common.h"
+
+using namespace std;
+
+
+
+/*!
+  Slant depth along the axis of a shower of zenith angle theta in a curved atmosphere. The density profile is
+  integrated once along the axis, which hits the ground at altitude 0 km, from the top of the atmosphere down to the
+  ground. The resulting slant depth to altitude relation is tabulated on a uniform grid, so each conversion is a
+  single interpolation. Below ground the last tabulated segment is extrapolated, as for the atmosphere itself.
+ */
+class TSlantGeometry
+{
+  public :
+    //! Constructor. theta in degrees.
+    TSlantGeometry(TAtmosphereHandle atmosphere, double theta);
+
+    //! Returns #fTheta
+    double GetZenith() const {return fTheta;}
+
+    //! Returns #fGroundDepth
+    double GetGroundDepth() const {return fGroundDepth;}
+
+    //! Altitude in km at slant depth in \f$ g . cm^{-2} \f$
+    double GetAltitude(double depth) const {return fAltitude.Eval(depth);}
+
+    //! Altitudes in km at the size slant depths in \f$ g . cm^{-2} \f$
+    void GetAltitude(unsigned int size, const double * depth, double * altitude) const {fAltitude.Eval(size,depth,altitude);}
+
+    //! Slant depth in \f$ g . cm^{-2} \f$ at altitude in km
+    double GetSlantDepth(double altitude) const {return fSlantDepth.Eval(altitude);}
+
+  private :
+    //! Zenith angle in degrees
+    double fTheta;
+
+    //! Slant depth at ground
+    double fGroundDepth;
+
+    //! Altitude as a function of slant depth
+    TInterpolator fAltitude;
+
+    //! Slant depth as a function of altitude
+    TInterpolator fSlantDepth;
+};
+
+//! Shared read-only slant geometry
+typedef shared_ptr<const TSlantGeometry> TSlantGeometryHandle;
+
+/*!
+  Returns the slant geometry of zenith angle theta (degrees), built once per atmosphere and zenith angle (thread
+  safe). The cache keeps the 16 most recently used geometries (about 0.7 MB each), so a few fixed zenith angles are
+  built once, while a continuous zenith angle builds a geometry per shower (about 1 ms) without growing the memory.
+  The cache does not keep the atmosphere alive: the geometries of an atmosphere are dropped once it is deleted.
+ */
+TSlantGeometryHandle GetSlantGeometry(TAtmosphereHandle atmosphere, double theta);
+
+//! Same as above for the size zenith angles theta, written in geometry, with a single lock of the cache for the cached ones
+void GetSlantGeometry(TAtmosphereHandle atmosphere, unsigned int size, const double * theta, TSlantGeometryHandle * geometry);
+
+#endif
@@ -0,0 +1,204 @@
+#include "lateral.h"
+#include "common.h"
+
+#include <cmath>
+#include <iostream>
+
+using namespace kMathConstants;
+using namespace kPhysicalConstants;
+
+
+
+namespace
+{
+  //! Smallest angle to the axis, as sin(alpha)
+  const double kMinimumSinAlpha = 1.e-4;
+
+  //! \f$ \pi \f$
+  const double Pi = 2.*PiOver2;
+
+  //! Emission points below this fraction of the largest one are skipped
+  const double kWeightThreshold = 1.e-7;
+
+  /*!
+    Tables shared by all the kernels: exp(-x) on [0,kExpMax] and asin(s)/s on [0,kAsinMax], both with linear
+    interpolation (relative errors below 1e-5 and 1e-7)
+   */
+  class TKernelTables
+  {
+    public :
+      TKernelTables()
+      {
+        fExp.resize(kExpSize+2);
+        for(unsigned int i = 0; i < fExp.size(); i++) fExp[i] = exp(-(double) i/kExpScale);
+        fAsin.resize(kAsinSize+2);
+        fAsin[0] = 1.;
+        for(unsigned int i = 1; i < fAsin.size(); i++) {double s = (double) i/kAsinScale; fAsin[i] = asin(s)/s;}
+      }
+
+      //! exp(-x)
+      double Exp(double x) const
+      {
+        if( x < 0. ) return exp(-x);
+        if( x >= kExpMax ) return 0.;
+        double u = x*kExpScale;
+        unsigned int i = (unsigned int) u;
+        return fExp[i]+(u-i)*(fExp[i+1]-fExp[i]);
+      }
+
+      //! Angle alpha in [0,pi/2] such that sin(alpha) = s
+      double Angle(double s) const
+      {
+        if( s >= kAsinMax ) return asin(s < 1. ? s : 1.);
+        double u = s*kAsinScale;
+        unsigned int i = (unsigned int) u;
+        return s*(fAsin[i]+(u-i)*(fAsin[i+1]-fAsin[i]));
+      }
+
+    private :
+      static const unsigned int kExpScale = 256;
+      static const unsigned int kExpSize = 50*kExpScale;
+      static constexpr double kExpMax = 50.;
+      static const unsigned int kAsinScale = 4096;
+      static const unsigned int kAsinSize = 4055;
+      static constexpr double kAsinMax = 0.99;
+
+      vector<double> fExp;
+      vector<double> fAsin;
+  };
+
+  const TKernelTables & GetKernelTables()
+  {
+    static const TKernelTables tables;
+
+    return tables;
+  }
+}
+
+
+
+TLateralDensity::TLateralDensity(TAtmosphereHandle atmosphere, double waveMin, double waveMax, double groundAltitude) :
+  fCherenkov(atmosphere,waveMin,waveMax)
+{
+  fGroundAltitude = groundAltitude;
+  fAxis[0] = 0.;
+  fAxis[1] = 0.;
+  fAxis[2] = 1.;
+  GetKernelTables();
+}
+
+
+
+void TLateralDensity::SetShower(TShower * shower)
+{
+  // Photons and angular distribution of every step
+  fCherenkov.SetShower(shower);
+  fCherenkov.ComputeProfile(fProfile);
+  fCherenkov.SetShower(0);
+
+  // Shower axis
+  double theta, phi;
+  shower->GetIncomingDirection(theta,phi);
+  fAxis[0] = sin(theta*DTOR)*cos(phi*DTOR);
+  fAxis[1] = sin(theta*DTOR)*sin(phi*DTOR);
+  fAxis[2] = cos(theta*DTOR);
+
+  // Emission points above ground
+  const vector<double> & T = fProfile.fT;
+  unsigned int size = T.size();
+  double DeltaX = size > 1 ? (T[1]-T[0])*X0 : 0.;
+  double WeightMax = 0.;
+  for(unsigned int i = 0; i < size; i++) if( fProfile.fNc[i] > WeightMax ) WeightMax = fProfile.fNc[i];
+
+  fX.clear(); fY.clear(); fZ.clear();
+  fWeight.clear();
+  fA.clear(); fB.clear();
+  fInvThetaC.clear(); fInvThetaCC.clear();
+  for(unsigned int i = 0; i < size; i++)
+    {
+      double height = (fProfile.fAltitude[i]-fGroundAltitude)*1.e3; // in m
+      if( height <= 0. || !(fProfile.fNc[i] > kWeightThreshold*WeightMax) ) continue;
+
+      double length = height/fAxis[2];
+      fX.push_back(length*fAxis[0]);
+      fY.push_back(length*fAxis[1]);
+      fZ.push_back(height);
+      double weight = fProfile.fNc[i]*DeltaX*height/TwoPi; // with cos(iota) = height/d and 1/(2 pi sin(alpha))
+      if( !fProfile.fTransmission.empty() ) weight *= fProfile.fTransmission[i];
+      fWeight.push_back(weight);
+
+      const TAngularDistribution & distribution = fProfile.fAngularDistribution[i];
+      fA.push_back(distribution.GetA()/(distribution.GetThetaC()*distribution.GetNorm()));
+      fB.push_back(distribution.GetB()/(distribution.GetThetaCC()*distribution.GetNorm()));
+      fInvThetaC.push_back(1./distribution.GetThetaC());
+      fInvThetaCC.push_back(1./distribution.GetThetaCC());
+    }
+}
+
+
+
+double TLateralDensity::Density(double x, double y) const
+{
+  const TKernelTables & tables = GetKernelTables();
+  unsigned int size = fWeight.size();
+
+  double density = 0.;
+  for(unsigned int i = 0; i < size; i++)
+    {
+      // From the emission point to the ground position
+      double rx = x-fX[i], ry = y-fY[i], rz = -fZ[i];
+      double distance2 = rx*rx+ry*ry+rz*rz;
+      double InvDistance = 1./sqrt(distance2);
+
+      // Angle to the axis from its sine, |r x axis|/d (accurate enough down to kMinimumSinAlpha)
+      double projection = rx*fAxis[0]+ry*fAxis[1]+rz*fAxis[2];
+      double transverse2 = distance2-projection*projection;
+      double SinAlpha = transverse2 > 0. ? sqrt(transverse2)*InvDistance : 0.;
+      if( SinAlpha < kMinimumSinAlpha ) SinAlpha = kMinimumSinAlpha;
+      double alpha = tables.Angle(SinAlpha);
+      if( projection > 0. ) alpha = Pi-alpha; // photon going up the axis
+
+      double f = fA[i]*tables.Exp(alpha*fInvThetaC[i])+fB[i]*tables.Exp(alpha*fInvThetaCC[i]);
+      density += fWeight[i]*f/SinAlpha*InvDistance*InvDistance*InvDistance;
+    }
+
+  return density;
+}
+
+
+
+void TLateralDensity::ComputeDensity(unsigned int size, const double * x, const double * y, double * density, TThreadPool & pool)
+{
+  pool.ParallelFor(size,[&](unsigned int index, unsigned int) {density[index] = Density(x[index],y[index]);},16);
+}
+
+
+
+void TLateralDensity::ComputeDensity(unsigned int size, const double * x, const double * y, double * density, unsigned int nThreads)
+{
+  TThreadPool pool(nThreads);
+  ComputeDensity(size,x,y,density,pool);
+}
+
+
+
+void TLateralDensity::ComputeMap(unsigned int nx, double xMin, double xMax, unsigned int ny, double yMin, double yMax, TMatrix2D & map, TThreadPool & pool)
+{
+  if( nx < 2 || ny < 2 ) {cout << "ERROR: density map needs at least 2 bins per axis. EXITING." << endl; exit(0);}
+
+  vector<double> x = Bins(nx,xMin,xMax), y = Bins(ny,yMin,yMax);
+  map.Resize(nx,ny);
+  pool.ParallelFor(nx*ny,[&](unsigned int index, unsigned int)
+    {
+      unsigned int i = index/ny, j = index%ny;
+      map(i,j) = Density(x[i],y[j]);
+    },16);
+}
+
+
+
+void TLateralDensity::ComputeMap(unsigned int nx, double xMin, double xMax, unsigned int ny, double yMin, double yMax, TMatrix2D & map, unsigned int nThreads)
+{
+  TThreadPool pool(nThreads);
+  ComputeMap(nx,xMin,xMax,ny,yMin,yMax,map,pool);
+}
@@ -0,0 +1,85 @@
+#ifndef _LATERAL_H
+#define _LATERAL_H
+
+#include <vector>
+#include <string>
+
+#include "atmosphere.h"
+#include "cherenkov.h"
+#include "matrix.h"
+#include "shower.h"
+#include "threadpool.h"
+
+using namespace std;
+
+
+
+/*!
+  Density of Cherenkov photons on a horizontal ground plane. Each step of a shower emits its photons (TCherenkov)
+  from a point of the shower axis, with the angular distribution of the step. The number of photons reaching a
+  ground position at distance d from the emission point, at an angle alpha to the axis and an incidence angle iota
+  to the vertical, is
+  \f[ dN/dA = N_c \Delta X \frac{f(\alpha)}{2 \pi \sin \alpha} \frac{\cos \iota}{d^2} \f]
+  summed over all steps. The axis hits the ground at (0, 0) and comes from the zenith and azimuth angles of the
+  shower. Steps with a negligible yield are skipped. The kernels use shared tables for the exponentials and the
+  angle to the axis, and ground positions are distributed over a thread pool. The attenuation in the atmosphere is
+  included when a TTransmission is given to the Cherenkov calculator (TCherenkov::SetTransmission). Angles closer
+  than 1e-4 rad to the axis are rounded up to it, which bounds the density at the core.
+ */
+class TLateralDensity
+{
+  public :
+    //! Constructor. groundAltitude in km, waveMin and waveMax in cm.
+    TLateralDensity(TAtmosphereHandle atmosphere, double waveMin, double waveMax, double groundAltitude = 0.);
+
+    //! Cherenkov calculator, e.g. to load a photon table, to use the curved geometry or to set the transmission
+    TCherenkov & GetCherenkov() {return fCherenkov;}
+
+    //! Computes the emission points of a generated shower (the shower is not kept)
+    void SetShower(TShower * shower);
+
+    //! Returns the number of emission points of the current shower
+    unsigned int GetNumberOfEmissionPoints() const {return fWeight.size();}
+
+    //! Photon density in \f$ m^{-2} \f$ at the size ground positions (x[i], y[i]) in m, written in density
+    void ComputeDensity(unsigned int size, const double * x, const double * y, double * density, TThreadPool & pool);
+
+    //! Same as above with nThreads threads (all hardware threads when nThreads = 0)
+    void ComputeDensity(unsigned int size, const double * x, const double * y, double * density, unsigned int nThreads = 0);
+
+    //! Photon density in \f$ m^{-2} \f$ on a regular grid of the ground: map(i,j) at x[i] and y[j], in m (at least 2 bins per axis)
+    void ComputeMap(unsigned int nx, double xMin, double xMax, unsigned int ny, double yMin, double yMax, TMatrix2D & map, TThreadPool & pool);
+
+    //! Same as above with nThreads threads (all hardware threads when nThreads = 0)
+    void ComputeMap(unsigned int nx, double xMin, double xMax, unsigned int ny, double yMin, double yMax, TMatrix2D & map, unsigned int nThreads = 0);
+
+  private :
+    //! Photon density at ground position (x, y)
+    double Density(double x, double y) const;
+
+    //! Cherenkov calculator
+    TCherenkov fCherenkov;
+
+    //! Observables of the steps of the current shower
+    TCherenkovProfile fProfile;
+
+    //! Altitude of the ground in km
+    double fGroundAltitude;
+
+    //! Unit vector along the shower axis, pointing upwards
+    double fAxis[3];
+
+    //! Position of the emission points in m (ground frame)
+    vector<double> fX, fY, fZ;
+
+    //! Number of photons emitted at each emission point
+    vector<double> fWeight;
+
+    //! Angular distribution per radian of each emission point, fA*exp(-alpha/thetac)+fB*exp(-alpha/thetacc)
+    vector<double> fA, fB;
+
+    //! Inverse of the angular scales in radians
+    vector<double> fInvThetaC, fInvThetaCC;
+};
+
+#endif
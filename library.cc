@@ -0,0 +1,346 @@
+#include "library.h"
+#include "ensemble.h"
+#include "yield.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cmath>
+#include <stdint.h>
+
+using namespace kMathConstants;
+
+
+
+namespace
+{
+  //! Binary header of the libraries written by TProfileLibrary::Save
+  struct TProfileLibraryHeader
+  {
+    char fMagic[8];
+    uint32_t fNEnergy;
+    uint32_t fNZenith;
+    uint32_t fNumberOfSteps;
+    uint32_t fHasCherenkov;
+    double fLogEnergyMin;
+    double fLogEnergyMax;
+    double fZenithMax;
+    double fKey[4];
+  };
+
+  const char kProfileLibraryMagic[8] = {'P','R','O','F','L','I','B','2'};
+
+  //! Number of values following the header
+  size_t NumberOfValues(unsigned int nEnergy, unsigned int nZenith, unsigned int nSteps, bool cherenkov)
+  {
+    size_t nodes = (size_t)nEnergy*nZenith;
+    return nSteps+nodes+nodes*nSteps*(cherenkov ? 2 : 1);
+  }
+
+  //! Lower node i0 and weight frac of the upper one of x in a grid of n nodes between xMin and xMax, clamped to it
+  void Locate(double x, unsigned int n, double xMin, double xMax, unsigned int & i0, double & frac)
+  {
+    i0 = 0;
+    frac = 0.;
+    if( n < 2 ) return;
+    double position = (x-xMin)/(xMax-xMin)*(n-1);
+    if( !(position > 0.) ) return;
+    if( position >= n-1 ) {i0 = n-2; frac = 1.; return;}
+    i0 = (unsigned int)position;
+    frac = position-i0;
+  }
+}
+
+
+
+TProfileLibrary::TProfileLibrary()
+{
+  fNEnergy = 0;
+  fLogEnergyMin = 0.;
+  fLogEnergyMax = 0.;
+  fNZenith = 0;
+  fZenithMax = 0.;
+  fNumberOfSteps = 0;
+  fHasCherenkov = false;
+  for(unsigned int i = 0; i < 4; i++) fKey[i] = 0.;
+  fWaveMin = 0.;
+  fWaveMax = 0.;
+  fFile = 0;
+  fData = 0;
+  fTmax = 0;
+  fNe = 0;
+  fNcPerNe = 0;
+}
+
+
+
+TProfileLibrary::~TProfileLibrary()
+{
+  if( fFile ) delete fFile;
+}
+
+
+
+void TProfileLibrary::SetCherenkov(TAtmosphereHandle atmosphere, double waveMin, double waveMax)
+{
+  fAtmosphere = atmosphere;
+  fWaveMin = waveMin; // in cm
+  fWaveMax = waveMax; // in cm
+}
+
+
+
+void TProfileLibrary::Build(unsigned int nEnergy, double energyMin, double energyMax, unsigned int nZenith, double zenithMax,
+                            TThreadPool & pool, unsigned int nShowers, unsigned int step)
+{
+  if( nEnergy == 0 || nZenith == 0 || nShowers == 0 || energyMin <= 0. ||
+      (nEnergy > 1 && energyMax <= energyMin) || (nZenith > 1 && zenithMax <= 0.) )
+    {
+      cout << "ERROR: inconsistent grid of the profile library. EXITING." << endl;
+      exit(0);
+    }
+
+  fNEnergy = nEnergy;
+  fLogEnergyMin = log10(energyMin);
+  fLogEnergyMax = log10(energyMax);
+  fNZenith = nZenith;
+  fZenithMax = zenithMax;
+  fHasCherenkov = fAtmosphere ? true : false;
+  for(unsigned int i = 0; i < 4; i++) fKey[i] = 0.;
+  if( fHasCherenkov )
+    {
+      fKey[0] = fWaveMin;
+      fKey[1] = fWaveMax;
+      fKey[2] = TCherenkovYield(fWaveMin,fWaveMax).GetBandIntegral();
+      fKey[3] = fAtmosphere->GetFingerprint();
+    }
+
+  // Mean profile of an ensemble of showers at each node, every ensemble running on all the threads of pool
+  vector<double> Tmax, Ne, Nc;
+  vector<double> T;
+  for(unsigned int i = 0; i < fNEnergy; i++)
+    {
+      double logEnergy = fNEnergy > 1 ? fLogEnergyMin+(fLogEnergyMax-fLogEnergyMin)*i/(fNEnergy-1) : fLogEnergyMin;
+      for(unsigned int j = 0; j < fNZenith; j++)
+        {
+          double coord[2] = {fNZenith > 1 ? fZenithMax*j/(fNZenith-1) : 0.,0.};
+          TEnsemble Ensemble(pow(10.,logEnergy),coord,step);
+          if( fHasCherenkov ) Ensemble.SetCherenkov(fAtmosphere,fWaveMin,fWaveMax);
+          Ensemble.Run(nShowers,pool);
+
+          if( T.empty() )
+            {
+              T = Ensemble.GetDepth();
+              fNumberOfSteps = T.size();
+              Ne.reserve((size_t)fNEnergy*fNZenith*fNumberOfSteps);
+              if( fHasCherenkov ) Nc.reserve((size_t)fNEnergy*fNZenith*fNumberOfSteps);
+            }
+          if( fNumberOfSteps < 2 || Ensemble.GetDepth().size() != fNumberOfSteps ) {cout << "ERROR: inconsistent depth grid between the nodes. EXITING." << endl; exit(0);}
+
+          size_t start = Ne.size();
+          Ne.resize(start+fNumberOfSteps,0.);
+          if( fHasCherenkov ) Nc.resize(start+fNumberOfSteps,0.);
+          double SumTmax = 0.;
+          for(unsigned int k = 0; k < nShowers; k++)
+            {
+              const TEnsembleShower & shower = Ensemble.GetShower(k);
+              SumTmax += shower.fTmax;
+              for(unsigned int l = 0; l < fNumberOfSteps; l++) Ne[start+l] += shower.fNe[l]/nShowers;
+              if( fHasCherenkov ) for(unsigned int l = 0; l < fNumberOfSteps; l++) Nc[start+l] += shower.fNc[l]/nShowers;
+            }
+          Tmax.push_back(SumTmax/nShowers);
+        }
+    }
+
+  if( fFile ) {delete fFile; fFile = 0;}
+  fValues.clear();
+  fValues.reserve(NumberOfValues(fNEnergy,fNZenith,fNumberOfSteps,fHasCherenkov));
+  fValues.insert(fValues.end(),T.begin(),T.end());
+  fValues.insert(fValues.end(),Tmax.begin(),Tmax.end());
+  fValues.insert(fValues.end(),Ne.begin(),Ne.end());
+  for(size_t l = 0; l < Nc.size(); l++) fValues.push_back(Ne[l] > 0. ? Nc[l]/Ne[l] : 0.); // photons per electron
+  SetData(&fValues[0]);
+}
+
+
+
+bool TProfileLibrary::Save(string fileName) const
+{
+  if( !GetStatus() ) {cout << "Empty library, nothing written in " << fileName << "." << endl; return false;}
+
+  TProfileLibraryHeader header;
+  memcpy(header.fMagic,kProfileLibraryMagic,sizeof(kProfileLibraryMagic));
+  header.fNEnergy = fNEnergy;
+  header.fNZenith = fNZenith;
+  header.fNumberOfSteps = fNumberOfSteps;
+  header.fHasCherenkov = fHasCherenkov;
+  header.fLogEnergyMin = fLogEnergyMin;
+  header.fLogEnergyMax = fLogEnergyMax;
+  header.fZenithMax = fZenithMax;
+  for(unsigned int i = 0; i < 4; i++) header.fKey[i] = fKey[i];
+
+  ofstream libraryFile(fileName.c_str(),ios::binary);
+  libraryFile.write((const char *) &header,sizeof(header));
+  libraryFile.write((const char *) fData,sizeof(double)*NumberOfValues(fNEnergy,fNZenith,fNumberOfSteps,fHasCherenkov));
+  libraryFile.close();
+  if( !libraryFile ) {cout << "Cannot write " << fileName << "." << endl; return false;}
+
+  return true;
+}
+
+
+
+bool TProfileLibrary::Load(string fileName)
+{
+  TMappedFile * file = new TMappedFile(fileName);
+  if( !file->IsOpen() ) {delete file; return false;}
+
+  TProfileLibraryHeader header;
+  if( file->GetSize() < sizeof(header) ) {cout << fileName << " is not a profile library." << endl; delete file; return false;}
+  memcpy(&header,file->GetData(),sizeof(header));
+  if( memcmp(header.fMagic,kProfileLibraryMagic,sizeof(kProfileLibraryMagic)) != 0 || header.fNEnergy == 0 || header.fNZenith == 0 ||
+      header.fNumberOfSteps < 2 || header.fHasCherenkov > 1 ||
+      file->GetSize() != sizeof(header)+sizeof(double)*NumberOfValues(header.fNEnergy,header.fNZenith,header.fNumberOfSteps,header.fHasCherenkov) )
+    {
+      cout << fileName << " is not a profile library." << endl;
+      delete file;
+      return false;
+    }
+
+  if( fFile ) delete fFile;
+  fValues.clear();
+  fFile = file;
+  fNEnergy = header.fNEnergy;
+  fNZenith = header.fNZenith;
+  fNumberOfSteps = header.fNumberOfSteps;
+  fHasCherenkov = header.fHasCherenkov;
+  fLogEnergyMin = header.fLogEnergyMin;
+  fLogEnergyMax = header.fLogEnergyMax;
+  fZenithMax = header.fZenithMax;
+  for(unsigned int i = 0; i < 4; i++) fKey[i] = header.fKey[i];
+  SetData((const double *) (fFile->GetData()+sizeof(header)));
+
+  return true;
+}
+
+
+
+void TProfileLibrary::SetData(const double * data)
+{
+  size_t nodes = (size_t)fNEnergy*fNZenith;
+  fData = data;
+  fTmax = fData+fNumberOfSteps;
+  fNe = fTmax+nodes;
+  fNcPerNe = fHasCherenkov ? fNe+nodes*fNumberOfSteps : 0;
+}
+
+
+
+bool TProfileLibrary::IsCompatible(TAtmosphereHandle atmosphere, double waveMin, double waveMax) const
+{
+  if( !fHasCherenkov ) return false;
+
+  double key[4] = {waveMin,waveMax,TCherenkovYield(waveMin,waveMax).GetBandIntegral(),atmosphere->GetFingerprint()};
+  for(unsigned int i = 0; i < 4; i++) if( fabs(fKey[i]-key[i]) > 1.e-12*fabs(key[i]) ) return false;
+
+  return true;
+}
+
+
+
+void TProfileLibrary::AddShifted(const double * node, double shift, double weight, double * profile) const
+{
+  // The depth grid is uniform, so step k reads the node at k+offset+frac, 0 outside of the grid
+  double step = (fData[fNumberOfSteps-1]-fData[0])/(fNumberOfSteps-1);
+  double position = shift/step;
+  double offset = floor(position);
+  double frac = position-offset;
+  if( !(fabs(offset) < fNumberOfSteps) ) return;
+  int n = fNumberOfSteps, l0 = (int)offset;
+  int first = l0 < 0 ? -l0 : 0;
+  int end = frac > 0. ? n-1-l0 : n-l0; // with frac > 0, the last node has no upper neighbour
+  if( end > n ) end = n;
+  if( frac > 0. ) for(int k = first; k < end; k++) profile[k] += weight*(node[k+l0]+frac*(node[k+l0+1]-node[k+l0]));
+  else for(int k = first; k < end; k++) profile[k] += weight*node[k+l0];
+}
+
+
+
+double TProfileLibrary::GetProfile(double energy, double zenith, double * Ne, double * Nc) const
+{
+  if( !GetStatus() ) {cout << "ERROR: empty profile library. EXITING." << endl; exit(0);}
+
+  double logEnergy = log10(energy);
+  unsigned int i0, j0;
+  double u, v;
+  Locate(logEnergy,fNEnergy,fLogEnergyMin,fLogEnergyMax,i0,u);
+  Locate(zenith,fNZenith,0.,fZenithMax,j0,v);
+
+  // The 4 surrounding nodes, the upper ones only when they count
+  unsigned int node[4];
+  double weight[4], scale[4];
+  unsigned int nNodes = 0;
+  for(unsigned int a = 0; a < 2; a++)
+    {
+      double wu = a == 0 ? 1.-u : u;
+      if( wu == 0. ) continue;
+      unsigned int i = i0+a;
+      double logNode = fNEnergy > 1 ? fLogEnergyMin+(fLogEnergyMax-fLogEnergyMin)*i/(fNEnergy-1) : fLogEnergyMin;
+      for(unsigned int b = 0; b < 2; b++)
+        {
+          double wv = b == 0 ? 1.-v : v;
+          if( wv == 0. ) continue;
+          node[nNodes] = i*fNZenith+j0+b;
+          weight[nNodes] = wu*wv;
+          scale[nNodes] = pow(10.,logEnergy-logNode); // number of particles proportional to energy
+          nNodes++;
+        }
+    }
+
+  // Nodes aligned on the interpolated depth of maximum
+  double Tmax = 0.;
+  for(unsigned int n = 0; n < nNodes; n++) Tmax += weight[n]*fTmax[node[n]];
+
+  for(unsigned int k = 0; k < fNumberOfSteps; k++) Ne[k] = 0.;
+  for(unsigned int n = 0; n < nNodes; n++) AddShifted(fNe+(size_t)node[n]*fNumberOfSteps,fTmax[node[n]]-Tmax,weight[n]*scale[n],Ne);
+  if( !Nc || !fHasCherenkov ) return Tmax;
+
+  /* Photons per electron at fixed slant depth, i.e. at the same age. They also depend on the altitude, given by the
+     vertical depth which scales with cos(zenith) at a given slant depth, so the zenith angles are weighted linearly
+     in cos(zenith). */
+  double ratioWeight[4];
+  for(unsigned int n = 0; n < nNodes; n++)
+    {
+      ratioWeight[n] = weight[n];
+      if( fNZenith < 2 || v == 0. || v == 1. ) continue;
+      double CosLow = cos(fZenithMax*j0/(fNZenith-1)*DTOR), CosHigh = cos(fZenithMax*(j0+1)/(fNZenith-1)*DTOR);
+      double w = (CosLow-cos(zenith*DTOR))/(CosLow-CosHigh);
+      ratioWeight[n] *= node[n]%fNZenith == j0 ? (1.-w)/(1.-v) : w/v;
+    }
+  for(unsigned int k = 0; k < fNumberOfSteps; k++)
+    {
+      double ratio = 0., norm = 0.;
+      for(unsigned int n = 0; n < nNodes; n++)
+        {
+          size_t index = (size_t)node[n]*fNumberOfSteps+k;
+          if( !(fNe[index] > 0.) ) continue;
+          ratio += ratioWeight[n]*fNcPerNe[index];
+          norm += ratioWeight[n];
+        }
+      Nc[k] = norm > 0. ? Ne[k]*ratio/norm : 0.;
+    }
+
+  return Tmax;
+}
+
+
+
+double TProfileLibrary::GetProfile(double energy, double zenith, vector<double> & Ne, vector<double> & Nc) const
+{
+  if( !GetStatus() ) {cout << "ERROR: empty profile library. EXITING." << endl; exit(0);}
+
+  Ne.resize(fNumberOfSteps);
+  Nc.resize(fHasCherenkov ? fNumberOfSteps : 0);
+
+  return GetProfile(energy,zenith,&Ne[0],fHasCherenkov ? &Nc[0] : 0);
+}
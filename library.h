@@ -0,0 +1,131 @@
+#ifndef _LIBRARY_H
+#define _LIBRARY_H
+
+#include <vector>
+#include <string>
+
+#include "atmosphere.h"
+#include "mappedfile.h"
+#include "threadpool.h"
+
+using namespace std;
+
+
+
+/*!
+  Library of mean longitudinal profiles on a grid of energies (uniform in log) and zenith angles, built once with
+  TEnsemble and optionally holding the matching number of Cherenkov photons produced (TCherenkov). The library is
+  saved in a single binary file and memory-mapped later on, so a profile is a lookup instead of a simulation.
+
+  Between the nodes of the grid, the profiles of electrons are interpolated bilinearly in (log energy, zenith) after
+  aligning them on the interpolated depth of maximum: each node profile is shifted by the difference of its Tmax and
+  scaled by the ratio of energies. This keeps the width and the height of the profile between energies, where a
+  plain interpolation at fixed depth would give two bumps. The Cherenkov photons are not shifted, since they also
+  depend on the altitude of each depth: the number of photons per electron of the nodes is interpolated at fixed
+  slant depth (weighting the zenith angles in cos(zenith), to which the vertical depth at a given slant depth is
+  proportional) and multiplied by the interpolated number of electrons.
+ */
+class TProfileLibrary
+{
+  public :
+    //! Constructor of an empty library
+    TProfileLibrary();
+
+    //! Destructor
+    ~TProfileLibrary();
+
+    //! Also tabulates the number of Cherenkov photons produced between waveMin and waveMax (in cm), to call before #Build
+    void SetCherenkov(TAtmosphereHandle atmosphere, double waveMin, double waveMax);
+
+    /*!
+      Builds the mean profiles of nShowers showers of step steps at nEnergy energies (eV) in [energyMin,energyMax]
+      and nZenith zenith angles in [0,zenithMax] degrees, with the threads of pool. Azimuth is 0.
+     */
+    void Build(unsigned int nEnergy, double energyMin, double energyMax, unsigned int nZenith, double zenithMax,
+               TThreadPool & pool, unsigned int nShowers = 100, unsigned int step = 800);
+
+    //! Writes the library in a binary file
+    bool Save(string fileName) const;
+
+    //! Memory-maps a library written by #Save
+    bool Load(string fileName);
+
+    //! Tells you whether the library holds profiles or not
+    bool GetStatus() const {return fData != 0;}
+
+    //! Tells you whether the library holds numbers of Cherenkov photons or not
+    bool HasCherenkov() const {return fHasCherenkov;}
+
+    //! Tells you whether the numbers of Cherenkov photons were computed for this atmosphere and wavelength band
+    bool IsCompatible(TAtmosphereHandle atmosphere, double waveMin, double waveMax) const;
+
+    //! Number of steps of the profiles
+    unsigned int GetNumberOfSteps() const {return fNumberOfSteps;}
+
+    //! Depth grid in unit of radiation length (#GetNumberOfSteps values)
+    const double * GetDepth() const {return fData;}
+
+    /*!
+      Interpolated mean profile at energy (eV) and zenith (degrees): number of electrons/positrons written in Ne and,
+      if the library has them and Nc is not null, number of Cherenkov photons produced per \f$ g . cm^{-2} \f$
+      written in Nc (#GetNumberOfSteps values each). Points outside of the grid are clamped to it. Returns Tmax.
+     */
+    double GetProfile(double energy, double zenith, double * Ne, double * Nc = 0) const;
+
+    //! Same as above in vectors (Nc is left empty without Cherenkov)
+    double GetProfile(double energy, double zenith, vector<double> & Ne, vector<double> & Nc) const;
+
+  private :
+    //! Not copyable
+    TProfileLibrary(const TProfileLibrary &);
+
+    //! Not assignable
+    TProfileLibrary & operator=(const TProfileLibrary &);
+
+    //! Sets the pointers into the values starting at data
+    void SetData(const double * data);
+
+    //! Adds weight times the profile of node shifted by shift (in unit of radiation length) to profile
+    void AddShifted(const double * node, double shift, double weight, double * profile) const;
+
+    //! Number of energies
+    unsigned int fNEnergy;
+
+    //! log10 of the smallest and largest energies
+    double fLogEnergyMin, fLogEnergyMax;
+
+    //! Number of zenith angles
+    unsigned int fNZenith;
+
+    //! Largest zenith angle
+    double fZenithMax;
+
+    //! Number of steps of the profiles
+    unsigned int fNumberOfSteps;
+
+    //! Tells you whether #fNcPerNe is filled or not
+    bool fHasCherenkov;
+
+    //! Atmosphere fingerprint and wavelength band of the Cherenkov photons
+    double fKey[4];
+
+    //! Atmosphere and wavelength band given to #SetCherenkov
+    TAtmosphereHandle fAtmosphere;
+    double fWaveMin, fWaveMax;
+
+    //! Values built by #Build: depth grid, Tmax of the nodes, then their Ne and Cherenkov photons per electron (node i*#fNZenith+j)
+    vector<double> fValues;
+
+    //! Mapped file of #Load
+    TMappedFile * fFile;
+
+    //! Start of the values, in #fValues or in #fFile
+    const double * fData;
+
+    //! Tmax, Ne and Cherenkov photons per electron of the nodes, within #fData
+    const double * fTmax;
+    const double * fNe;
+    const double * fNcPerNe;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#include "mappedfile.h"
+
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+
+TMappedFile::TMappedFile(string fileName)
+{
+  fData = 0;
+  fSize = 0;
+
+  int descriptor = open(fileName.c_str(),O_RDONLY);
+  if( descriptor == -1 ) {cout << "Cannot open " << fileName << "." << endl; return;}
+
+  struct stat fileStat;
+  if( fstat(descriptor,&fileStat) == -1 || fileStat.st_size == 0 )
+    {
+      cout << "Cannot map " << fileName << " (empty file?)." << endl;
+      close(descriptor);
+      return;
+    }
+
+  void * data = mmap(0,fileStat.st_size,PROT_READ,MAP_SHARED,descriptor,0);
+  close(descriptor); // the mapping stays valid
+  if( data == MAP_FAILED ) {cout << "Cannot map " << fileName << "." << endl; return;}
+
+  fData = (const char *) data;
+  fSize = fileStat.st_size;
+}
+
+
+
+TMappedFile::~TMappedFile()
+{
+  if( fData ) munmap((void *) fData,fSize);
+}
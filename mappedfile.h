@@ -0,0 +1,44 @@
+#ifndef _MAPPEDFILE_H
+#define _MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+
+
+//! Read-only memory mapping of a whole file
+class TMappedFile
+{
+  public :
+    //! Constructor. Maps fileName, check #IsOpen afterwards
+    TMappedFile(string fileName);
+
+    //! Destructor. Unmaps the file
+    ~TMappedFile();
+
+    //! Tells you whether the file has been mapped or not
+    bool IsOpen() const {return fData != 0;}
+
+    //! Returns #fSize
+    size_t GetSize() const {return fSize;}
+
+    //! Returns #fData
+    const char * GetData() const {return fData;}
+
+  private :
+    //! Not copyable
+    TMappedFile(const TMappedFile &);
+
+    //! Not assignable
+    TMappedFile & operator=(const TMappedFile &);
+
+    //! Mapped content
+    const char * fData;
+
+    //! Size of the file in bytes
+    size_t fSize;
+};
+
+#endif
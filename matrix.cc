@@ -0,0 +1,75 @@
+#include "matrix.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <stdint.h>
+
+
+
+namespace
+{
+  //! Binary header of the matrices written by TMatrix2D::Save
+  struct TMatrix2DHeader
+  {
+    char fMagic[8];
+    uint32_t fRows;
+    uint32_t fColumns;
+  };
+
+  const char kMatrix2DMagic[8] = {'M','A','T','R','I','X','2','D'};
+}
+
+
+
+vector<double> TMatrixView::GetValues() const
+{
+  vector<double> values(fSize);
+  for(unsigned int i = 0; i < fSize; i++) values[i] = fData[(size_t)i*fStride];
+
+  return values;
+}
+
+
+
+bool TMatrix2D::Save(string fileName) const
+{
+  TMatrix2DHeader header;
+  memcpy(header.fMagic,kMatrix2DMagic,sizeof(kMatrix2DMagic));
+  header.fRows = fRows;
+  header.fColumns = fColumns;
+
+  ofstream matrixFile(fileName.c_str(),ios::binary);
+  matrixFile.write((const char *) &header,sizeof(header));
+  if( !fValues.empty() ) matrixFile.write((const char *) &fValues[0],sizeof(double)*fValues.size());
+  matrixFile.close();
+  if( !matrixFile ) {cout << "Cannot write " << fileName << "." << endl; return false;}
+
+  return true;
+}
+
+
+
+bool TMatrix2D::Load(string fileName)
+{
+  ifstream matrixFile(fileName.c_str(),ios::binary);
+  if( !matrixFile ) {cout << "Cannot open " << fileName << "." << endl; return false;}
+
+  TMatrix2DHeader header;
+  matrixFile.read((char *) &header,sizeof(header));
+  if( !matrixFile || memcmp(header.fMagic,kMatrix2DMagic,sizeof(kMatrix2DMagic)) != 0 )
+    {
+      cout << fileName << " is not a matrix." << endl;
+      return false;
+    }
+
+  vector<double> values((size_t)header.fRows*header.fColumns);
+  if( !values.empty() ) matrixFile.read((char *) &values[0],sizeof(double)*values.size());
+  if( !matrixFile ) {cout << fileName << " is truncated." << endl; return false;}
+
+  fRows = header.fRows;
+  fColumns = header.fColumns;
+  fValues.swap(values);
+
+  return true;
+}
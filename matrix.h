@@ -0,0 +1,125 @@
+#ifndef _MATRIX_H
+#define _MATRIX_H
+
+#include <string>
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+
+
+//! Read-only view of size values separated by stride, e.g. a row or a column of a TMatrix2D
+class TMatrixView
+{
+  public :
+    //! Constructor
+    TMatrixView(const double * data, unsigned int size, unsigned int stride = 1) : fData(data), fSize(size), fStride(stride) {}
+
+    //! Value i
+    double operator[](unsigned int i) const {return fData[(size_t)i*fStride];}
+
+    //! Returns #fSize
+    unsigned int GetSize() const {return fSize;}
+
+    //! Copy of the values
+    vector<double> GetValues() const;
+
+  private :
+    //! First value
+    const double * fData;
+
+    //! Number of values
+    unsigned int fSize;
+
+    //! Distance between two values
+    unsigned int fStride;
+};
+
+
+
+/*!
+  Matrix of doubles stored row-major in a single block: value (i,j) is at index i*columns+j. Rows are contiguous
+  and can be scanned or handed over as plain arrays. Moving a matrix only moves the block, and resizing it to the
+  same number of values does not allocate. The matrix can be written to a binary file in one block.
+ */
+class TMatrix2D
+{
+  public :
+    //! Constructor of an empty matrix
+    TMatrix2D() : fRows(0), fColumns(0) {}
+
+    //! Constructor
+    TMatrix2D(unsigned int rows, unsigned int columns, double value = 0.) : fRows(rows), fColumns(columns), fValues((size_t)rows*columns,value) {}
+
+    //! Copy constructor
+    TMatrix2D(const TMatrix2D & matrix) = default;
+
+    //! Move constructor. matrix is left empty.
+    TMatrix2D(TMatrix2D && matrix) : fRows(matrix.fRows), fColumns(matrix.fColumns), fValues(std::move(matrix.fValues)) {matrix.fRows = matrix.fColumns = 0;}
+
+    //! Copy assignment
+    TMatrix2D & operator=(const TMatrix2D & matrix) = default;
+
+    //! Move assignment. matrix is left empty.
+    TMatrix2D & operator=(TMatrix2D && matrix)
+    {
+      fRows = matrix.fRows;
+      fColumns = matrix.fColumns;
+      fValues.swap(matrix.fValues);
+      matrix.fRows = matrix.fColumns = 0;
+      matrix.fValues.clear();
+      return *this;
+    }
+
+    //! Changes the shape of the matrix. The values kept are in storage order, the new ones are 0.
+    void Resize(unsigned int rows, unsigned int columns) {fRows = rows; fColumns = columns; fValues.resize((size_t)rows*columns);}
+
+    //! Returns #fRows
+    unsigned int GetRows() const {return fRows;}
+
+    //! Returns #fColumns
+    unsigned int GetColumns() const {return fColumns;}
+
+    //! Value (i,j)
+    double & operator()(unsigned int i, unsigned int j) {return fValues[(size_t)i*fColumns+j];}
+
+    //! Value (i,j)
+    double operator()(unsigned int i, unsigned int j) const {return fValues[(size_t)i*fColumns+j];}
+
+    //! Values of row i
+    double * GetRow(unsigned int i) {return &fValues[(size_t)i*fColumns];}
+
+    //! Values of row i
+    const double * GetRow(unsigned int i) const {return &fValues[(size_t)i*fColumns];}
+
+    //! View of row i
+    TMatrixView GetRowView(unsigned int i) const {return TMatrixView(GetRow(i),fColumns);}
+
+    //! View of column j
+    TMatrixView GetColumnView(unsigned int j) const {return TMatrixView(&fValues[j],fRows,fColumns);}
+
+    //! All values, row after row
+    double * GetData() {return &fValues[0];}
+
+    //! All values, row after row
+    const double * GetData() const {return &fValues[0];}
+
+    //! Writes the matrix in a binary file
+    bool Save(string fileName) const;
+
+    //! Reads a matrix written by #Save
+    bool Load(string fileName);
+
+  private :
+    //! Number of rows
+    unsigned int fRows;
+
+    //! Number of columns
+    unsigned int fColumns;
+
+    //! Values
+    vector<double> fValues;
+};
+
+#endif
@@ -0,0 +1,134 @@
+#include "random.h"
+
+#include <cmath>
+#include <atomic>
+
+
+
+namespace
+{
+  const uint32_t kPhiloxM0 = 0xD2511F53;
+  const uint32_t kPhiloxM1 = 0xCD9E8D57;
+  const uint32_t kPhiloxW0 = 0x9E3779B9;
+  const uint32_t kPhiloxW1 = 0xBB67AE85;
+
+  std::atomic<uint64_t> gRunSeed(0);
+  std::atomic<uint64_t> gNextIndex(0);
+}
+
+
+
+void TRandomStream::SetSeed(uint64_t seed, uint64_t index)
+{
+  fKey[0] = (uint32_t) seed;
+  fKey[1] = (uint32_t) (seed >> 32);
+  fCounter[0] = 0;
+  fCounter[1] = 0;
+  fCounter[2] = (uint32_t) index;
+  fCounter[3] = (uint32_t) (index >> 32);
+  fPosition = 2;
+}
+
+
+
+double TRandomStream::Gaus(double mean, double sigma)
+{
+  double u1 = Rndm();
+  double u2 = Rndm();
+
+  return mean+sigma*sqrt(-2.*log(u1))*cos(6.28318530717958623200*u2);
+}
+
+
+
+void TRandomStream::NextBlock()
+{
+  uint32_t c[4] = {fCounter[0], fCounter[1], fCounter[2], fCounter[3]};
+  uint32_t k[2] = {fKey[0], fKey[1]};
+  for(unsigned int round = 0; round < 10; round++)
+    {
+      uint64_t product0 = (uint64_t) kPhiloxM0*c[0];
+      uint64_t product1 = (uint64_t) kPhiloxM1*c[2];
+      uint32_t next[4] = {(uint32_t) (product1 >> 32) ^ c[1] ^ k[0], (uint32_t) product1,
+                          (uint32_t) (product0 >> 32) ^ c[3] ^ k[1], (uint32_t) product0};
+      for(unsigned int i = 0; i < 4; i++) c[i] = next[i];
+      k[0] += kPhiloxW0;
+      k[1] += kPhiloxW1;
+    }
+  for(unsigned int i = 0; i < 4; i++) fBlock[i] = c[i];
+  fPosition = 0;
+
+  // 64 bits block number
+  if( ++fCounter[0] == 0 ) fCounter[1]++;
+}
+
+
+
+void TRandomStream::Rndm4(unsigned int size, double * u)
+{
+  // Lanes of consecutive block numbers
+  const unsigned int kLanes = 8;
+  uint64_t block = ((uint64_t) fCounter[1] << 32) | fCounter[0];
+  for(unsigned int first = 0; first < size; first += kLanes)
+    {
+      unsigned int lanes = size-first < kLanes ? size-first : kLanes;
+      uint32_t c0[kLanes], c1[kLanes], c2[kLanes], c3[kLanes];
+      for(unsigned int l = 0; l < kLanes; l++)
+        {
+          uint64_t number = block+l;
+          c0[l] = (uint32_t) number;
+          c1[l] = (uint32_t) (number >> 32);
+          c2[l] = fCounter[2];
+          c3[l] = fCounter[3];
+        }
+      uint32_t k0 = fKey[0], k1 = fKey[1];
+      for(unsigned int round = 0; round < 10; round++)
+        {
+          for(unsigned int l = 0; l < kLanes; l++)
+            {
+              uint64_t product0 = (uint64_t) kPhiloxM0*c0[l];
+              uint64_t product1 = (uint64_t) kPhiloxM1*c2[l];
+              c0[l] = (uint32_t) (product1 >> 32) ^ c1[l] ^ k0;
+              c2[l] = (uint32_t) (product0 >> 32) ^ c3[l] ^ k1;
+              c1[l] = (uint32_t) product1;
+              c3[l] = (uint32_t) product0;
+            }
+          k0 += kPhiloxW0;
+          k1 += kPhiloxW1;
+        }
+      double * v = u+4*first;
+      for(unsigned int l = 0; l < lanes; l++)
+        {
+          v[4*l] = (c0[l]+0.5)*(1./4294967296.);
+          v[4*l+1] = (c1[l]+0.5)*(1./4294967296.);
+          v[4*l+2] = (c2[l]+0.5)*(1./4294967296.);
+          v[4*l+3] = (c3[l]+0.5)*(1./4294967296.);
+        }
+      block += lanes;
+    }
+  fCounter[0] = (uint32_t) block;
+  fCounter[1] = (uint32_t) (block >> 32);
+  if( size > 0 ) fPosition = 2;
+}
+
+
+
+void TRandomStream::SetRunSeed(uint64_t seed)
+{
+  gRunSeed = seed;
+  gNextIndex = 0;
+}
+
+
+
+uint64_t TRandomStream::GetRunSeed()
+{
+  return gRunSeed;
+}
+
+
+
+uint64_t TRandomStream::NextIndex(uint64_t count)
+{
+  return gNextIndex.fetch_add(count);
+}
@@ -0,0 +1,72 @@
+#ifndef _RANDOM_H
+#define _RANDOM_H
+
+#include <stdint.h>
+
+/*!
+  Counter-based random stream (Philox4x32-10, Salmon et al. 2011). A stream is entirely defined by a run seed and a
+  stream index, e.g. the shower number: it needs no allocation, any stream can be regenerated on its own and streams
+  drawn in parallel do not depend on each other.
+ */
+class TRandomStream
+{
+  public :
+    //! Constructor
+    TRandomStream(uint64_t seed = 0, uint64_t index = 0) {SetSeed(seed,index);}
+
+    //! Restarts the stream index of run seed
+    void SetSeed(uint64_t seed, uint64_t index);
+
+    //! Uniform deviate in ]0,1[
+    double Rndm()
+    {
+      if( fPosition == 2 ) NextBlock();
+      uint64_t bits = ((uint64_t) fBlock[2*fPosition] << 32) | fBlock[2*fPosition+1];
+      fPosition++;
+      return ((bits >> 11)+0.5)*(1./9007199254740992.);
+    }
+
+    //! Four uniform deviates in ]0,1[ with a resolution of \f$ 2^{-32} \f$, from one block (faster than four #Rndm)
+    void Rndm4(double * u)
+    {
+      NextBlock();
+      for(unsigned int i = 0; i < 4; i++) u[i] = (fBlock[i]+0.5)*(1./4294967296.);
+      fPosition = 2;
+    }
+
+    /*!
+      size blocks of four uniform deviates written in u (4 size values), the same as size calls of #Rndm4. Several
+      blocks are computed side by side so that the rounds of Philox are interleaved (and vectorized by the compiler).
+     */
+    void Rndm4(unsigned int size, double * u);
+
+    //! Gaussian deviate (Box-Muller)
+    double Gaus(double mean = 0., double sigma = 1.);
+
+    //! Sets the run seed used by #NextIndex streams and restarts their numbering
+    static void SetRunSeed(uint64_t seed);
+
+    //! Returns the run seed
+    static uint64_t GetRunSeed();
+
+    //! Reserves count consecutive new stream indices of the run seed and returns the first one (thread safe)
+    static uint64_t NextIndex(uint64_t count = 1);
+
+  private :
+    //! Draws the next block of four 32 bits words
+    void NextBlock();
+
+    //! Key (run seed)
+    uint32_t fKey[2];
+
+    //! Counter: block number and stream index
+    uint32_t fCounter[4];
+
+    //! Current block
+    uint32_t fBlock[4];
+
+    //! Number of 64 bits words of #fBlock already used
+    unsigned int fPosition;
+};
+
+#endif
@@ -0,0 +1,280 @@
+#include "results.h"
+
+#include <iostream>
+#include <cstring>
+#include <cstddef>
+#include <stdint.h>
+
+using namespace kResultColumns;
+
+
+
+namespace
+{
+  //! Binary header of the result files
+  struct TResultHeader
+  {
+    char fMagic[8];
+    uint32_t fNumberOfSteps;
+    uint32_t fChunkSize;
+    uint32_t fColumns;
+    uint32_t fSpare;
+  };
+
+  //! Entry of the index of the chunks
+  struct TResultChunk
+  {
+    uint64_t fOffset;
+    uint64_t fNumberOfShowers;
+  };
+
+  //! Binary trailer of the result files
+  struct TResultTrailer
+  {
+    uint64_t fNumberOfChunks;
+    uint64_t fIndexOffset;
+    uint64_t fNumberOfShowers;
+    char fMagic[8];
+  };
+
+  const char kResultMagic[8] = {'C','H','R','E','S','L','T','1'};
+
+  //! Number of values of column for one shower of nSteps steps
+  unsigned int ColumnWidth(unsigned int column, unsigned int nSteps) {return column < kNumberOfScalars ? 1 : nSteps;}
+}
+
+
+
+TResultWriter::TResultWriter(string fileName, const vector<double> & T, unsigned int chunkSize)
+{
+  fFileName = fileName;
+  fNumberOfSteps = T.size();
+  fChunkSize = chunkSize > 0 ? chunkSize : 1;
+  fColumns = 0;
+  fChunkFill = 0;
+  fNumberOfShowers = 0;
+
+  fFile.open(fileName.c_str(),ios::binary);
+  if( !fFile ) {cout << "Cannot write " << fileName << "." << endl; return;}
+
+  TResultHeader header;
+  memcpy(header.fMagic,kResultMagic,sizeof(kResultMagic));
+  header.fNumberOfSteps = fNumberOfSteps;
+  header.fChunkSize = fChunkSize;
+  header.fColumns = 0; // known at the first shower, written by Close
+  header.fSpare = 0;
+  fFile.write((const char *) &header,sizeof(header));
+  if( fNumberOfSteps > 0 ) fFile.write((const char *) &T[0],sizeof(double)*fNumberOfSteps);
+}
+
+
+
+TResultWriter::~TResultWriter()
+{
+  if( IsOpen() ) Close();
+}
+
+
+
+void TResultWriter::Fill(const TShower & shower, const TCherenkovProfile & profile)
+{
+  double scalars[kNumberOfScalars];
+  scalars[Energy] = shower.GetEnergy();
+  shower.GetIncomingDirection(scalars[Zenith],scalars[Azimuth]);
+  scalars[T1] = shower.GetT1();
+  scalars[Tmax] = shower.GetTmax();
+  Fill(scalars,shower.GetNumberOfElectrons(),profile.fNc.empty() ? 0 : &profile.fNc,
+       profile.fAngularDistribution.empty() ? 0 : &profile.fAngularDistribution);
+}
+
+
+
+void TResultWriter::Fill(double energy, const double * coord, const TEnsembleShower & shower)
+{
+  double scalars[kNumberOfScalars];
+  scalars[Energy] = energy;
+  scalars[Zenith] = coord[0];
+  scalars[Azimuth] = coord[1];
+  scalars[T1] = shower.fT1;
+  scalars[Tmax] = shower.fTmax;
+  Fill(scalars,shower.fNe,shower.fNc.empty() ? 0 : &shower.fNc,0);
+}
+
+
+
+void TResultWriter::Fill(const double * scalars, const vector<double> & Ne, const vector<double> * Nc, const vector<TAngularDistribution> * angular)
+{
+  if( !IsOpen() ) {cout << "ERROR: " << fFileName << " is not open. EXITING." << endl; exit(0);}
+
+  // The first shower sets the columns
+  unsigned int columns = (1u << kNumberOfScalars)-1;
+  columns |= 1u << kResultColumns::Ne;
+  if( Nc ) columns |= 1u << kResultColumns::Nc;
+  if( angular ) columns |= (1u << A) | (1u << B) | (1u << ThetaC) | (1u << ThetaCC);
+  if( fColumns == 0 ) fColumns = columns;
+  if( columns != fColumns ) {cout << "ERROR: all the showers of " << fFileName << " must have the same columns. EXITING." << endl; exit(0);}
+  if( Ne.size() != fNumberOfSteps || (Nc && Nc->size() != fNumberOfSteps) || (angular && angular->size() != fNumberOfSteps) )
+    {
+      cout << "ERROR: all the showers of " << fFileName << " must have the depth grid of the file. EXITING." << endl;
+      exit(0);
+    }
+
+  for(unsigned int c = 0; c < kNumberOfScalars; c++) fBuffer[c].push_back(scalars[c]);
+  fBuffer[kResultColumns::Ne].insert(fBuffer[kResultColumns::Ne].end(),Ne.begin(),Ne.end());
+  if( Nc ) fBuffer[kResultColumns::Nc].insert(fBuffer[kResultColumns::Nc].end(),Nc->begin(),Nc->end());
+  if( angular )
+    for(unsigned int i = 0; i < fNumberOfSteps; i++)
+      {
+        const TAngularDistribution & distribution = (*angular)[i];
+        fBuffer[A].push_back(distribution.GetA());
+        fBuffer[B].push_back(distribution.GetB());
+        fBuffer[ThetaC].push_back(distribution.GetThetaC());
+        fBuffer[ThetaCC].push_back(distribution.GetThetaCC());
+      }
+
+  fNumberOfShowers++;
+  if( ++fChunkFill == fChunkSize ) Flush();
+}
+
+
+
+void TResultWriter::Flush()
+{
+  if( fChunkFill == 0 ) return;
+
+  fChunkOffset.push_back((unsigned long) fFile.tellp());
+  fChunkShowers.push_back(fChunkFill);
+  for(unsigned int c = 0; c < kNumberOfColumns; c++)
+    {
+      if( !((fColumns >> c) & 1) ) continue;
+      fFile.write((const char *) &fBuffer[c][0],sizeof(double)*fBuffer[c].size());
+      fBuffer[c].clear();
+    }
+  fChunkFill = 0;
+}
+
+
+
+bool TResultWriter::Close()
+{
+  if( !IsOpen() ) return false;
+
+  Flush();
+
+  // Index of the chunks and trailer
+  TResultTrailer trailer;
+  trailer.fNumberOfChunks = fChunkOffset.size();
+  trailer.fIndexOffset = (uint64_t) fFile.tellp();
+  trailer.fNumberOfShowers = fNumberOfShowers;
+  memcpy(trailer.fMagic,kResultMagic,sizeof(kResultMagic));
+  for(unsigned int k = 0; k < fChunkOffset.size(); k++)
+    {
+      TResultChunk chunk;
+      chunk.fOffset = fChunkOffset[k];
+      chunk.fNumberOfShowers = fChunkShowers[k];
+      fFile.write((const char *) &chunk,sizeof(chunk));
+    }
+  fFile.write((const char *) &trailer,sizeof(trailer));
+
+  // Columns, now known
+  uint32_t columns = fColumns;
+  fFile.seekp(offsetof(TResultHeader,fColumns));
+  fFile.write((const char *) &columns,sizeof(columns));
+
+  fFile.close();
+  if( !fFile ) {cout << "Cannot write " << fFileName << "." << endl; return false;}
+
+  return true;
+}
+
+
+
+TResultReader::TResultReader()
+{
+  fFile = 0;
+  fNumberOfShowers = 0;
+  fNumberOfSteps = 0;
+  fChunkSize = 1;
+  fColumns = 0;
+  fDepth = 0;
+}
+
+
+
+TResultReader::~TResultReader()
+{
+  if( fFile ) delete fFile;
+}
+
+
+
+bool TResultReader::Open(string fileName)
+{
+  TMappedFile * file = new TMappedFile(fileName);
+  if( !file->IsOpen() ) {delete file; return false;}
+
+  // Header and trailer
+  const char * data = file->GetData();
+  size_t size = file->GetSize();
+  TResultHeader header;
+  TResultTrailer trailer;
+  bool valid = size >= sizeof(header)+sizeof(trailer);
+  if( valid )
+    {
+      memcpy(&header,data,sizeof(header));
+      memcpy(&trailer,data+size-sizeof(trailer),sizeof(trailer));
+      valid = memcmp(header.fMagic,kResultMagic,sizeof(kResultMagic)) == 0 && memcmp(trailer.fMagic,kResultMagic,sizeof(kResultMagic)) == 0 &&
+              header.fChunkSize > 0 && trailer.fIndexOffset <= size-sizeof(trailer) &&
+              trailer.fNumberOfChunks <= (size-sizeof(trailer)-trailer.fIndexOffset)/sizeof(TResultChunk) &&
+              trailer.fIndexOffset+trailer.fNumberOfChunks*sizeof(TResultChunk)+sizeof(trailer) == size &&
+              sizeof(header)+sizeof(double)*(uint64_t)header.fNumberOfSteps <= trailer.fIndexOffset; // depth grid
+    }
+
+  // Index of the chunks, and the columns in each of them
+  vector<unsigned long> ChunkShowers;
+  vector<const double *> column;
+  unsigned long NumberOfShowers = 0;
+  for(uint64_t k = 0; valid && k < trailer.fNumberOfChunks; k++)
+    {
+      TResultChunk chunk;
+      memcpy(&chunk,data+trailer.fIndexOffset+k*sizeof(chunk),sizeof(chunk));
+      valid = chunk.fNumberOfShowers > 0 && chunk.fNumberOfShowers <= header.fChunkSize &&
+              (k+1 == trailer.fNumberOfChunks || chunk.fNumberOfShowers == header.fChunkSize) &&
+              chunk.fOffset >= sizeof(header)+sizeof(double)*header.fNumberOfSteps && chunk.fOffset%sizeof(double) == 0;
+      uint64_t offset = chunk.fOffset;
+      valid = valid && offset <= trailer.fIndexOffset;
+      for(unsigned int c = 0; valid && c < kNumberOfColumns; c++)
+        {
+          if( !((header.fColumns >> c) & 1) ) {column.push_back(0); continue;}
+          // Each column ends before the index, compared in values so that corrupt sizes do not overflow
+          uint64_t values = chunk.fNumberOfShowers*ColumnWidth(c,header.fNumberOfSteps);
+          valid = values <= (trailer.fIndexOffset-offset)/sizeof(double);
+          column.push_back((const double *) (data+offset));
+          offset += sizeof(double)*values;
+        }
+      ChunkShowers.push_back(chunk.fNumberOfShowers);
+      NumberOfShowers += chunk.fNumberOfShowers;
+    }
+  if( !valid || NumberOfShowers != trailer.fNumberOfShowers ) {cout << fileName << " is not a result file." << endl; delete file; return false;}
+
+  if( fFile ) delete fFile;
+  fFile = file;
+  fNumberOfShowers = NumberOfShowers;
+  fNumberOfSteps = header.fNumberOfSteps;
+  fChunkSize = header.fChunkSize;
+  fColumns = header.fColumns;
+  fDepth = (const double *) (data+sizeof(header));
+  fChunkShowers.swap(ChunkShowers);
+  fColumn.swap(column);
+
+  return true;
+}
+
+
+
+TAngularDistribution TResultReader::GetAngularDistribution(unsigned long shower, unsigned int step) const
+{
+  if( !HasColumn(A) ) {cout << "ERROR: no angular distribution in the file. EXITING." << endl; exit(0);}
+
+  return TAngularDistribution(GetArray(A,shower)[step],GetArray(B,shower)[step],GetArray(ThetaC,shower)[step],GetArray(ThetaCC,shower)[step]);
+}
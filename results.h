@@ -0,0 +1,229 @@
+#ifndef _RESULTS_H
+#define _RESULTS_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+
+#include "angular.h"
+#include "cherenkov.h"
+#include "ensemble.h"
+#include "mappedfile.h"
+#include "shower.h"
+
+using namespace std;
+
+
+
+//! Columns of a result file: one value per shower for the first kNumberOfScalars ones, one value per step for the others
+namespace kResultColumns
+{
+  //! Energy in eV
+  const unsigned int Energy = 0;
+
+  //! Zenith angle in degrees
+  const unsigned int Zenith = 1;
+
+  //! Azimuth angle in degrees
+  const unsigned int Azimuth = 2;
+
+  //! Depth of the first interaction in unit of radiation length
+  const unsigned int T1 = 3;
+
+  //! Depth at shower maximum in unit of radiation length
+  const unsigned int Tmax = 4;
+
+  //! Number of electrons/positrons
+  const unsigned int Ne = 5;
+
+  //! Number of Cherenkov photons produced per \f$ g . cm^{-2} \f$
+  const unsigned int Nc = 6;
+
+  //! Weight of the first exponential of the angular distribution (see TAngularDistribution)
+  const unsigned int A = 7;
+
+  //! Weight of the second exponential of the angular distribution
+  const unsigned int B = 8;
+
+  //! Angular scale of the first exponential in radians
+  const unsigned int ThetaC = 9;
+
+  //! Angular scale of the second exponential in radians
+  const unsigned int ThetaCC = 10;
+
+  //! Number of per shower columns
+  const unsigned int kNumberOfScalars = 5;
+
+  //! Number of columns
+  const unsigned int kNumberOfColumns = 11;
+}
+
+
+
+/*!
+  Streaming writer of a columnar result file. Showers with a common depth grid are buffered chunkSize at a time and
+  each chunk is written column by column, so the memory used does not depend on the number of showers. The columns
+  written are the ones given for the first shower (Nc and the angular distribution are optional). An index of the
+  chunks is appended when the file is closed. See TResultReader for the layout.
+ */
+class TResultWriter
+{
+  public :
+    //! Constructor. Opens fileName for showers with the depth grid T, check #IsOpen afterwards.
+    TResultWriter(string fileName, const vector<double> & T, unsigned int chunkSize = 256);
+
+    //! Destructor. Closes the file.
+    ~TResultWriter();
+
+    //! Tells you whether the file is open or not
+    bool IsOpen() const {return fFile.is_open();}
+
+    //! Adds a shower and the observables of its steps computed by TCherenkov::ComputeProfile (may be empty)
+    void Fill(const TShower & shower, const TCherenkovProfile & profile);
+
+    //! Adds a shower of an ensemble of showers of energy and incoming direction coord
+    void Fill(double energy, const double * coord, const TEnsembleShower & shower);
+
+    //! Writes the last chunk and the index. Returns false if anything could not be written.
+    bool Close();
+
+    //! Returns #fNumberOfShowers
+    unsigned long GetNumberOfShowers() const {return fNumberOfShowers;}
+
+  private :
+    //! Not copyable
+    TResultWriter(const TResultWriter &);
+
+    //! Not assignable
+    TResultWriter & operator=(const TResultWriter &);
+
+    //! Adds a shower to the current chunk. Nc and angular may be null.
+    void Fill(const double * scalars, const vector<double> & Ne, const vector<double> * Nc, const vector<TAngularDistribution> * angular);
+
+    //! Writes the current chunk
+    void Flush();
+
+    //! Output file
+    ofstream fFile;
+
+    //! Name of the output file
+    string fFileName;
+
+    //! Number of steps of every shower
+    unsigned int fNumberOfSteps;
+
+    //! Maximum number of showers of a chunk
+    unsigned int fChunkSize;
+
+    //! Columns written, one bit per column (0 until the first shower)
+    unsigned int fColumns;
+
+    //! Values of the current chunk, column by column
+    vector<double> fBuffer[kResultColumns::kNumberOfColumns];
+
+    //! Number of showers in the current chunk
+    unsigned int fChunkFill;
+
+    //! Offset in the file and number of showers of the chunks written
+    vector<unsigned long> fChunkOffset, fChunkShowers;
+
+    //! Number of showers written
+    unsigned long fNumberOfShowers;
+};
+
+
+
+/*!
+  Reader of the result files written by TResultWriter. The file is memory-mapped and all the values are read in
+  place: scanning millions of showers involves neither parsing nor copying. Layout (native byte order):
+  - header: 8 bytes magic, number of steps, chunk size, column bits and one spare (4 bytes each), depth grid
+  - chunks: for each column present, the values of all the showers of the chunk (shower major for the step columns)
+  - index: offset (8 bytes) and number of showers (8 bytes) of every chunk
+  - trailer: number of chunks, offset of the index, number of showers (8 bytes each) and 8 bytes magic
+ */
+class TResultReader
+{
+  public :
+    //! Constructor of a closed reader
+    TResultReader();
+
+    //! Destructor
+    ~TResultReader();
+
+    //! Memory-maps fileName. Returns false if it is not a result file.
+    bool Open(string fileName);
+
+    //! Tells you whether a file is mapped or not
+    bool IsOpen() const {return fFile != 0;}
+
+    //! Returns #fNumberOfShowers
+    unsigned long GetNumberOfShowers() const {return fNumberOfShowers;}
+
+    //! Returns #fNumberOfSteps
+    unsigned int GetNumberOfSteps() const {return fNumberOfSteps;}
+
+    //! Depth grid in unit of radiation length (#GetNumberOfSteps values)
+    const double * GetDepth() const {return fDepth;}
+
+    //! Tells you whether column (see kResultColumns) is in the file or not
+    bool HasColumn(unsigned int column) const {return (fColumns >> column) & 1;}
+
+    //! Value of the per shower column of shower
+    double GetValue(unsigned int column, unsigned long shower) const
+    {
+      unsigned long chunk = shower/fChunkSize;
+      return fColumn[chunk*kResultColumns::kNumberOfColumns+column][shower-chunk*fChunkSize];
+    }
+
+    //! Values at each step of the per step column of shower (#GetNumberOfSteps values)
+    const double * GetArray(unsigned int column, unsigned long shower) const
+    {
+      unsigned long chunk = shower/fChunkSize;
+      return fColumn[chunk*kResultColumns::kNumberOfColumns+column]+(shower-chunk*fChunkSize)*fNumberOfSteps;
+    }
+
+    //! Number of chunks, to scan a column chunk by chunk
+    unsigned long GetNumberOfChunks() const {return fChunkShowers.size();}
+
+    //! Number of showers of chunk, the first one being shower chunk*#fChunkSize
+    unsigned long GetChunkSize(unsigned long chunk) const {return fChunkShowers[chunk];}
+
+    //! All the values of column in chunk, shower major for the per step columns
+    const double * GetColumn(unsigned int column, unsigned long chunk) const {return fColumn[chunk*kResultColumns::kNumberOfColumns+column];}
+
+    //! Angular distribution of step of shower (needs the angular columns)
+    TAngularDistribution GetAngularDistribution(unsigned long shower, unsigned int step) const;
+
+  private :
+    //! Not copyable
+    TResultReader(const TResultReader &);
+
+    //! Not assignable
+    TResultReader & operator=(const TResultReader &);
+
+    //! Mapped file
+    TMappedFile * fFile;
+
+    //! Number of showers
+    unsigned long fNumberOfShowers;
+
+    //! Number of steps of every shower
+    unsigned int fNumberOfSteps;
+
+    //! Maximum number of showers of a chunk
+    unsigned int fChunkSize;
+
+    //! Columns in the file, one bit per column
+    unsigned int fColumns;
+
+    //! Depth grid, in the mapped file
+    const double * fDepth;
+
+    //! Number of showers of each chunk
+    vector<unsigned long> fChunkShowers;
+
+    //! Start of each column of each chunk in the mapped file (null if absent), column c of chunk k at index k*kNumberOfColumns+c
+    vector<const double *> fColumn;
+};
+
+#endif
@@ -0,0 +1,399 @@
+#include "sampler.h"
+#include "common.h"
+#include "vectormath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+using namespace kMathConstants;
+using namespace kPhysicalConstants;
+
+
+
+namespace
+{
+  //! Angles to the axis below which sin and cos are computed from their Taylor series
+  const double kSmallAngle = 0.5;
+
+  //! Number of photons drawn together, so that their logarithms are computed by VectorLog
+  const unsigned int kBatch = 64;
+
+  //! Largest number of bunches of a shower
+  const double kMaximumNumberOfBunches = 4294967296.;
+
+  /*!
+    cos and sin of the azimuth 2 pi (k+1/2)/2^24 for a 24 bits integer k, from three tables of 256 angles combined by
+    rotations (exact up to rounding, unlike an interpolated table)
+   */
+  class TAzimuthTables
+  {
+    public :
+      TAzimuthTables()
+      {
+        for(unsigned int level = 0; level < 3; level++)
+          for(unsigned int k = 0; k < 256; k++)
+            {
+              double psi = TwoPi*(k*(double) (1u << 8*level)+(level == 0 ? 0.5 : 0.))/16777216.;
+              fCos[level][k] = cos(psi);
+              fSin[level][k] = sin(psi);
+            }
+      }
+
+      void CosSin(unsigned int k, double & c, double & s) const
+      {
+        unsigned int k0 = k & 255, k1 = (k >> 8) & 255, k2 = (k >> 16) & 255;
+        double c12 = fCos[2][k2]*fCos[1][k1]-fSin[2][k2]*fSin[1][k1];
+        double s12 = fSin[2][k2]*fCos[1][k1]+fCos[2][k2]*fSin[1][k1];
+        c = c12*fCos[0][k0]-s12*fSin[0][k0];
+        s = s12*fCos[0][k0]+c12*fSin[0][k0];
+      }
+
+    private :
+      double fCos[3][256];
+      double fSin[3][256];
+  };
+
+  const TAzimuthTables & GetAzimuthTables()
+  {
+    static const TAzimuthTables tables;
+
+    return tables;
+  }
+}
+
+
+
+TPhotonSampler::TPhotonSampler(double groundAltitude)
+{
+  fGroundAltitude = groundAltitude;
+  fAxis[0] = 0.; fAxis[1] = 0.; fAxis[2] = 1.;
+  fE1[0] = 1.; fE1[1] = 0.; fE1[2] = 0.;
+  fE2[0] = 0.; fE2[1] = 1.; fE2[2] = 0.;
+  fInvCosTheta = 1.;
+  fDepthStep = 0.;
+  fNumberOfPhotons = 0.;
+  fBunchSize = 1.;
+  fBudget = 0;
+  fExponent = 1.;
+  GetAzimuthTables();
+}
+
+
+
+void TPhotonSampler::SetShower(TCherenkov & cherenkov, TShower * shower)
+{
+  // As a batch of one shower, which leaves the shower bound to cherenkov alone
+  TCherenkovProfile profile;
+  cherenkov.ComputeProfile(vector<TShower *>(1,shower),profile);
+
+  double theta, phi;
+  shower->GetIncomingDirection(theta,phi);
+  SetProfile(profile,theta,phi);
+}
+
+
+
+void TPhotonSampler::SetProfile(const TCherenkovProfile & profile, double theta, double phi)
+{
+  if( profile.fNumberOfShowers != 1 ) {cout << "ERROR: the sampler takes the profile of a single shower. EXITING." << endl; exit(0);}
+
+  // Shower axis and the directions perpendicular to it
+  double SinTheta = sin(theta*DTOR), CosTheta = cos(theta*DTOR), SinPhi = sin(phi*DTOR), CosPhi = cos(phi*DTOR);
+  fAxis[0] = SinTheta*CosPhi; fAxis[1] = SinTheta*SinPhi; fAxis[2] = CosTheta;
+  fE1[0] = CosTheta*CosPhi; fE1[1] = CosTheta*SinPhi; fE1[2] = -SinTheta;
+  fE2[0] = -SinPhi; fE2[1] = CosPhi; fE2[2] = 0.;
+  fInvCosTheta = 1./CosTheta;
+
+  // Steps above ground, weighted by their number of photons
+  const vector<double> & T = profile.fT;
+  unsigned int size = T.size();
+  fDepthStep = size > 1 ? (T[1]-T[0])*X0 : 0.;
+  fStep.clear();
+  fAlias.clear();
+  fPhotons.clear();
+  for(unsigned int i = 0; i < size; i++)
+    {
+      double height = (profile.fAltitude[i]-fGroundAltitude)*1.e3; // in m
+      double photons = profile.fNc[i]*fDepthStep;
+      if( !profile.fTransmission.empty() ) photons *= profile.fTransmission[i];
+      if( height <= 0. || !(photons > 0.) ) continue;
+
+      TStep step;
+      step.fZ = height;
+      // Altitude change across the step from its neighbours
+      unsigned int previous = i > 0 ? i-1 : i, next = i+1 < size ? i+1 : i;
+      step.fSlope = next > previous ? (profile.fAltitude[next]-profile.fAltitude[previous])*1.e3/(next-previous) : 0.;
+      step.fDepth = T[i]*X0;
+
+      const TAngularDistribution & distribution = profile.fAngularDistribution[i];
+      double Pi = 2.*PiOver2;
+      step.fThetaC = distribution.GetThetaC();
+      step.fThetaCC = distribution.GetThetaCC();
+      step.fC = 1.-exp(-Pi/step.fThetaC);
+      step.fCC = 1.-exp(-Pi/step.fThetaCC);
+      step.fProbability = distribution.GetA()*step.fC/distribution.GetNorm();
+      TAlias alias;
+      alias.fProbability = 1.;
+      alias.fStep = fStep.size();
+      fStep.push_back(step);
+      fAlias.push_back(alias);
+      fPhotons.push_back(photons);
+    }
+
+  fNumberOfPhotons = 0.;
+  for(unsigned int i = 0; i < fPhotons.size(); i++) fNumberOfPhotons += fPhotons[i];
+  if( fStep.empty() ) return;
+
+  /* Alias table (Vose 1991): steps below the mean weight are completed by one above it */
+  unsigned int n = fStep.size();
+  vector<double> weight = fPhotons;
+  vector<unsigned int> small, large;
+  for(unsigned int i = 0; i < n; i++)
+    {
+      weight[i] *= n/fNumberOfPhotons;
+      if( weight[i] < 1. ) small.push_back(i);
+      else large.push_back(i);
+    }
+  while( !small.empty() && !large.empty() )
+    {
+      unsigned int s = small.back(), l = large.back();
+      small.pop_back();
+      fAlias[s].fProbability = weight[s];
+      fAlias[s].fStep = l;
+      weight[l] -= 1.-weight[s];
+      if( weight[l] < 1. ) {large.pop_back(); small.push_back(l);}
+    }
+  // What remains is 1 up to rounding errors
+  for(unsigned int i = 0; i < small.size(); i++) fAlias[small[i]].fProbability = 1.;
+  for(unsigned int i = 0; i < large.size(); i++) fAlias[large[i]].fProbability = 1.;
+}
+
+
+
+void TPhotonSampler::Draw(unsigned int size, TRandomStream & random, double weight, TPhoton * photons) const
+{
+  // One block of the random stream gives the four deviates of a photon
+  double u[4*kBatch];
+  unsigned int index[kBatch];
+  unsigned int nSteps = fStep.size();
+  random.Rndm4(size,u);
+  for(unsigned int k = 0; k < size; k++)
+    {
+      // Step (alias method)
+      double x = u[4*k]*nSteps;
+      index[k] = (unsigned int) x;
+      if( x-index[k] >= fAlias[index[k]].fProbability ) index[k] = fAlias[index[k]].fStep;
+    }
+  Draw(size,index,u,weight,photons);
+}
+
+
+
+void TPhotonSampler::Draw(unsigned int size, const unsigned int * index, const double * u, double weight, TPhoton * photons) const
+{
+  // Angles to the axis from the inverse cumulative distribution of one of the exponentials, all the logarithms at once
+  double argument[kBatch] = {0.}, scale[kBatch], alpha[kBatch];
+  for(unsigned int k = 0; k < size; k++)
+    {
+      const TStep & step = fStep[index[k]];
+      double w = u[4*k+2];
+      if( w < step.fProbability ) {argument[k] = 1.-w/step.fProbability*step.fC; scale[k] = -step.fThetaC;}
+      else {argument[k] = 1.-(w-step.fProbability)/(1.-step.fProbability)*step.fCC; scale[k] = -step.fThetaCC;}
+    }
+  VectorLog(size,argument,alpha);
+
+  for(unsigned int k = 0; k < size; k++) Draw(fStep[index[k]],&u[4*k],scale[k]*alpha[k],weight,photons[k]);
+}
+
+
+
+void TPhotonSampler::Draw(const TStep & step, const double * u, double alpha, double weight, TPhoton & photon) const
+{
+  // Emission point, uniform in depth within the step
+  double v = u[1]-0.5;
+  double z = step.fZ+v*step.fSlope;
+  double length = z*fInvCosTheta;
+  photon.fX = length*fAxis[0];
+  photon.fY = length*fAxis[1];
+  photon.fZ = z;
+  photon.fDepth = step.fDepth+v*fDepthStep;
+
+  double SinAlpha, CosAlpha;
+  if( alpha < kSmallAngle )
+    {
+      // Taylor series, accurate to 1e-13 below kSmallAngle
+      double alpha2 = alpha*alpha;
+      SinAlpha = alpha*(1.-alpha2/6.*(1.-alpha2/20.*(1.-alpha2/42.*(1.-alpha2/72.*(1.-alpha2/110.)))));
+      CosAlpha = 1.-alpha2/2.*(1.-alpha2/12.*(1.-alpha2/30.*(1.-alpha2/56.*(1.-alpha2/90.*(1.-alpha2/132.)))));
+    }
+  else
+    {
+      SinAlpha = sin(alpha);
+      CosAlpha = cos(alpha);
+    }
+
+  // Direction around the downward axis
+  double CosPsi, SinPsi;
+  GetAzimuthTables().CosSin((unsigned int) (u[3]*16777216.),CosPsi,SinPsi);
+  double a = SinAlpha*CosPsi, b = SinAlpha*SinPsi;
+  photon.fU = -CosAlpha*fAxis[0]+a*fE1[0]+b*fE2[0];
+  photon.fV = -CosAlpha*fAxis[1]+a*fE1[1]+b*fE2[1];
+  photon.fW = -CosAlpha*fAxis[2]+a*fE1[2];
+  photon.fWeight = weight;
+}
+
+
+
+void TPhotonSampler::Sample(uint64_t size, TPhoton * photons, TRandomStream & random) const
+{
+  if( fStep.empty() ) {cout << "ERROR: no photon to sample. EXITING." << endl; exit(0);}
+
+  double weight = fNumberOfPhotons/size;
+  for(uint64_t i = 0; i < size; i += kBatch) Draw((unsigned int) min((uint64_t) kBatch,size-i),random,weight,photons+i);
+}
+
+
+
+void TPhotonSampler::Sample(uint64_t size, const function<void(const TPhoton &)> & callback, TRandomStream & random) const
+{
+  if( fStep.empty() ) {cout << "ERROR: no photon to sample. EXITING." << endl; exit(0);}
+
+  double weight = fNumberOfPhotons/size;
+  TPhoton photons[kBatch];
+  for(uint64_t i = 0; i < size; i += kBatch)
+    {
+      unsigned int batch = (unsigned int) min((uint64_t) kBatch,size-i);
+      Draw(batch,random,weight,photons);
+      for(unsigned int k = 0; k < batch; k++) callback(photons[k]);
+    }
+}
+
+
+
+void TPhotonSampler::SetBunchSize(double size)
+{
+  if( !(size > 0.) ) {cout << "ERROR: bunch size must be positive. EXITING." << endl; exit(0);}
+
+  fBunchSize = size;
+  fBudget = 0;
+  if( fNumberOfPhotons > 0. ) GetMaximumNumberOfBunches(); // checks the number of bunches of the current shower
+}
+
+
+
+void TPhotonSampler::SetPhotonBudget(unsigned int budget, double exponent)
+{
+  if( budget == 0 ) {cout << "ERROR: photon budget must be positive. EXITING." << endl; exit(0);}
+
+  fBunchSize = 0.;
+  fBudget = budget;
+  fExponent = exponent;
+}
+
+
+
+void TPhotonSampler::Bunches(vector<double> & bunches, vector<double> & weight) const
+{
+  unsigned int size = fStep.size();
+  bunches.resize(size);
+  weight.resize(size);
+  if( fBudget == 0 )
+    {
+      for(unsigned int i = 0; i < size; i++)
+        {
+          bunches[i] = fPhotons[i]/fBunchSize;
+          weight[i] = fBunchSize;
+        }
+      return;
+    }
+
+  // Share of the budget of each step, and importance weight keeping its number of photons
+  double norm = 0.;
+  for(unsigned int i = 0; i < size; i++)
+    {
+      bunches[i] = fExponent == 1. ? fPhotons[i] : pow(fPhotons[i],fExponent);
+      norm += bunches[i];
+    }
+  for(unsigned int i = 0; i < size; i++)
+    {
+      bunches[i] *= fBudget/norm;
+      weight[i] = fPhotons[i]/bunches[i];
+    }
+}
+
+
+
+uint64_t TPhotonSampler::GetMaximumNumberOfBunches() const
+{
+  if( fBudget > 0 ) return fBudget;
+
+  double bunches = ceil(fNumberOfPhotons/fBunchSize);
+  if( bunches > kMaximumNumberOfBunches )
+    {
+      cout << "ERROR: bunches of " << fBunchSize << " photons give more than 2^32 bunches for " << fNumberOfPhotons << " photons. EXITING." << endl;
+      exit(0);
+    }
+
+  return (uint64_t) bunches;
+}
+
+
+
+template <typename Emitter> uint64_t TPhotonSampler::EmitSteps(TRandomStream & random, Emitter emit) const
+{
+  if( fStep.empty() ) return 0;
+  GetMaximumNumberOfBunches(); // checks the number of bunches
+
+  vector<double> bunches, weight;
+  Bunches(bunches,weight);
+
+  /* Systematic rounding: a single offset for the whole shower, so the cumulated number of bunches never drifts
+     from its expectation by one or more */
+  double offset = random.Rndm(), cumulated = 0.;
+  uint64_t emitted = 0;
+  double u[4*kBatch];
+  unsigned int index[kBatch];
+  TPhoton photons[kBatch];
+  for(unsigned int i = 0; i < fStep.size(); i++)
+    {
+      for(unsigned int k = 0; k < kBatch; k++) index[k] = i;
+      cumulated += bunches[i];
+      uint64_t last = (uint64_t) (cumulated+offset);
+      if( fBudget > 0 && (last > fBudget || i+1 == fStep.size()) ) last = fBudget; // rounding errors on the total
+      while( emitted < last )
+        {
+          unsigned int batch = (unsigned int) min((uint64_t) kBatch,last-emitted);
+          random.Rndm4(batch,u);
+          Draw(batch,index,u,weight[i],photons);
+          for(unsigned int k = 0; k < batch; k++)
+            {
+              if( !emit(photons[k]) ) return emitted;
+              emitted++;
+            }
+        }
+    }
+
+  return emitted;
+}
+
+
+
+uint64_t TPhotonSampler::Emit(uint64_t capacity, TPhoton * photons, TRandomStream & random) const
+{
+  uint64_t size = 0;
+
+  return EmitSteps(random,[&](const TPhoton & photon) -> bool
+    {
+      if( size == capacity ) return false;
+      photons[size++] = photon;
+      return true;
+    });
+}
+
+
+
+uint64_t TPhotonSampler::Emit(const function<void(const TPhoton &)> & callback, TRandomStream & random) const
+{
+  return EmitSteps(random,[&](const TPhoton & photon) -> bool {callback(photon); return true;});
+}
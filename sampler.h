@@ -0,0 +1,179 @@
+#ifndef _SAMPLER_H
+#define _SAMPLER_H
+
+#include <vector>
+#include <functional>
+
+#include "cherenkov.h"
+#include "random.h"
+#include "shower.h"
+
+using namespace std;
+
+
+
+//! Cherenkov photon, or bunch of photons, drawn by TPhotonSampler
+class TPhoton
+{
+  public :
+    //! Constructor
+    TPhoton() {}
+
+    //! Emission point in m, in the ground frame (the shower axis hits the ground at the origin)
+    double fX, fY, fZ;
+
+    //! Direction cosines of the photon
+    double fU, fV, fW;
+
+    //! Slant depth of the emission point in \f$ g . cm^{-2} \f$
+    double fDepth;
+
+    //! Number of photons represented
+    double fWeight;
+};
+
+
+
+/*!
+  Draws individual Cherenkov photons of a shower, with their emission point and direction, from the number of
+  photons and the angular distribution of each step (TCherenkovProfile). The step is drawn from an alias table
+  (Walker 1977) in constant time whatever the number of steps, and the emission depth is uniform within the step.
+  The angle to the axis is drawn by inverting the cumulative distribution in closed form: the distribution of
+  Nerling et al. is a mixture of two exponentials, so one of them is chosen with its probability and inverted
+  analytically. The azimuth around the axis is uniform. A photon takes a single block of the random stream
+  (TRandomStream::Rndm4) and one logarithm, so that no per-step table is needed. Photons are drawn in batches: the
+  blocks of a batch are generated together and its logarithms by VectorLog, which is vectorized with ARCHFLAGS. The ground frame is the one of
+  TLateralDensity: steps below the ground are skipped and the atmospheric transmission of the profile, if any, is
+  included in the number of photons. The sampler is read-only once set, so several threads can draw from it with their own random streams.
+ */
+class TPhotonSampler
+{
+  public :
+    //! Constructor of an empty sampler. groundAltitude in km.
+    TPhotonSampler(double groundAltitude = 0.);
+
+    //! Sets the steps from the profile of a single shower of zenith theta and azimuth phi (in degrees)
+    void SetProfile(const TCherenkovProfile & profile, double theta, double phi);
+
+    //! Computes the profile of a generated shower with cherenkov and sets the steps from it
+    void SetShower(TCherenkov & cherenkov, TShower * shower);
+
+    //! Total number of photons emitted above the ground (times the transmission)
+    double GetNumberOfPhotons() const {return fNumberOfPhotons;}
+
+    //! Number of steps that can be drawn
+    unsigned int GetNumberOfSteps() const {return fStep.size();}
+
+    /*!
+      Draws size photons in the preallocated buffer photons. Each one stands for #GetNumberOfPhotons / size photons,
+      so that size = #GetNumberOfPhotons (rounded) gives individual photons, with the callback version below for
+      large showers.
+     */
+    void Sample(uint64_t size, TPhoton * photons, TRandomStream & random) const;
+
+    //! Same as above, handing each photon to callback instead (no memory is used)
+    void Sample(uint64_t size, const function<void(const TPhoton &)> & callback, TRandomStream & random) const;
+
+    /*!
+      Bunching policy of #Emit: every bunch stands for size photons (1 by default, i.e. individual photons). The
+      number of bunches grows with the number of photons of the shower, see #GetMaximumNumberOfBunches. More than
+      \f$ 2^{32} \f$ bunches per shower is an error, e.g. individual photons of showers above a few \f$ 10^{14} eV \f$.
+     */
+    void SetBunchSize(double size);
+
+    /*!
+      Bunching policy of #Emit: exactly budget bunches per shower whatever its energy. Step i gets a share of them
+      proportional to \f$ N_i^{exponent} \f$, \f$ N_i \f$ being its number of photons, and its bunches carry
+      the importance weight that keeps the number of photons of the step unbiased. exponent = 1 gives bunches of
+      equal weight, smaller exponents give more bunches of smaller weight to the faint steps.
+     */
+    void SetPhotonBudget(unsigned int budget, double exponent = 1.);
+
+    //! Largest number of bunches #Emit can give with the current policy, e.g. to size its buffer
+    uint64_t GetMaximumNumberOfBunches() const;
+
+    /*!
+      Emits the photons of the shower in bunches, step after step along the shower, following the bunching policy.
+      The number of bunches of each step is its expected number rounded systematically, so the total is fixed by the
+      policy (exactly the budget) and each step is unbiased. Writes at most capacity bunches in photons and returns
+      their number.
+     */
+    uint64_t Emit(uint64_t capacity, TPhoton * photons, TRandomStream & random) const;
+
+    //! Same as above, handing each bunch to callback instead (no memory is used) and returning their number
+    uint64_t Emit(const function<void(const TPhoton &)> & callback, TRandomStream & random) const;
+
+  private :
+    //! Everything needed to place a photon of a step once it is drawn: 8 doubles, the 64 bytes of a cache line
+    struct TStep
+    {
+      double fZ;           // altitude above ground at the middle of the step, in m
+      double fSlope;       // altitude change across the step, in m
+      double fDepth;       // slant depth at the middle of the step
+      double fProbability; // probability of the first exponential of the angular distribution
+      double fThetaC;      // its angular scale in radians
+      double fC;           // its cumulative probability at pi, 1-exp(-pi/thetac)
+      double fThetaCC;     // same for the second exponential
+      double fCC;
+    };
+
+    //! Entry of the alias table of the steps, apart from #TStep so that drawing a step reads 16 bytes
+    struct TAlias
+    {
+      double fProbability; // probability to keep the step drawn uniformly
+      unsigned int fStep;  // step taken otherwise
+    };
+
+    //! Draws size photons (at most kBatch) of the alias table with weight
+    void Draw(unsigned int size, TRandomStream & random, double weight, TPhoton * photons) const;
+
+    //! Draws size photons (at most kBatch) of the steps index with weight, photon k from the uniform deviates u[4k+1], u[4k+2] and u[4k+3]
+    void Draw(unsigned int size, const unsigned int * index, const double * u, double weight, TPhoton * photons) const;
+
+    //! Places a photon of step at the angle alpha to the axis, from the uniform deviates u[1] and u[3]
+    void Draw(const TStep & step, const double * u, double alpha, double weight, TPhoton & photon) const;
+
+    //! Expected number of bunches of each step with the current policy, written in bunches, and their weight
+    void Bunches(vector<double> & bunches, vector<double> & weight) const;
+
+    //! Emission loop of #Emit over the steps, handing each bunch to emit
+    template <typename Emitter> uint64_t EmitSteps(TRandomStream & random, Emitter emit) const;
+
+    //! Altitude of the ground in km
+    double fGroundAltitude;
+
+    //! Unit vector along the shower axis, pointing upwards
+    double fAxis[3];
+
+    //! Unit vectors perpendicular to the axis (the second one is horizontal)
+    double fE1[3], fE2[3];
+
+    //! 1/cos(theta)
+    double fInvCosTheta;
+
+    //! Slant depth of a step
+    double fDepthStep;
+
+    //! Steps above the ground
+    vector<TStep> fStep;
+
+    //! Alias table of #fStep
+    vector<TAlias> fAlias;
+
+    //! Number of photons of each step of #fStep
+    vector<double> fPhotons;
+
+    //! Number of photons per bunch (0 with a budget)
+    double fBunchSize;
+
+    //! Number of bunches per shower (0 with a bunch size)
+    unsigned int fBudget;
+
+    //! Exponent of the share of #fBudget of each step
+    double fExponent;
+
+    //! Total number of photons
+    double fNumberOfPhotons;
+};
+
+#endif
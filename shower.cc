@@ -1,16 +1,32 @@
 #include "shower.h"
 #include "common.h"
 #include "conversion.h"
+#include "vectormath.h"
 
-#include <sys/time.h>
 #include <cmath>
 #include <iostream>
+#include <map>
+#include <mutex>
 
 
 
 using namespace kPhysicalConstants;
 
 
+
+TDepthGrid GetDepthGrid(unsigned int step)
+{
+  static mutex RegistryMutex;
+  static map<unsigned int, TDepthGrid> Registry;
+
+  lock_guard<mutex> lock(RegistryMutex);
+  TDepthGrid & grid = Registry[step];
+  if( !grid ) grid = TDepthGrid(new vector<double>(Bins(step,0.1,40)));
+
+  return grid;
+}
+
+
 TShower::TShower(double energy, double * coord, unsigned int step)
 {
   fEnergy = energy;
@@ -18,6 +34,23 @@ TShower::TShower(double energy, double * coord, unsigned int step)
   fPhi = coord[1];
   fStep = step;
   fStatus = false;
+  fSeed = TRandomStream::GetRunSeed();
+  fIndex = TRandomStream::NextIndex();
+
+  Init();
+}
+
+
+
+TShower::TShower(double energy, double * coord, unsigned int step, uint64_t seed, uint64_t index)
+{
+  fEnergy = energy;
+  fTheta = coord[0];
+  fPhi = coord[1];
+  fStep = step;
+  fStatus = false;
+  fSeed = seed;
+  fIndex = index;
 
   Init();
 }
@@ -26,7 +59,6 @@ TShower::TShower(double energy, double * coord, unsigned int step)
 
 TShower::~TShower()
 {
-  if( fRandom ) delete fRandom;
 }
 
 
@@ -34,18 +66,13 @@ TShower::~TShower()
 void TShower::Init()
 {
   // Random generator
-  unsigned int seed;
-  struct timeval MyTimeVal;
-  struct timezone MyTimeZone;
-  gettimeofday(&MyTimeVal,&MyTimeZone);
-  seed = (unsigned int) (MyTimeVal.tv_usec+(MyTimeVal.tv_sec % 1000)*1000000);
-  fRandom = new TRandom3(seed);
+  fRandom.SetSeed(fSeed,fIndex);
 
   // Depth of the first interaction
-  fT1 = -Tint*log(fRandom->Rndm());
+  fT1 = -Tint*log(fRandom.Rndm());
 
   // Number of radiation length
-  fT = Bins(fStep,0.1,40);
+  fT = ::GetDepthGrid(fStep);
 }
 
 
@@ -57,13 +84,14 @@ void TShower::GenerateShower()
   double y = log(fEnergy/Ec);
 
   // Number of radiation length measured from first interaction
+  const vector<double> & T = *fT;
   vector<double> Tprime(fStep);
-  for(unsigned int i = 0; i < fStep; i++) Tprime[i] = fT[i]-fT1;
+  for(unsigned int i = 0; i < fStep; i++) Tprime[i] = T[i]-fT1;
 
   // Fluctuations
   double Sprime = 0, F = 0, N1 = 0, Sigma = 0, Mu = 0;
   vector<double> LogN(fStep);
-  double RanNormal = fRandom->Gaus();
+  double RanNormal = fRandom.Gaus();
 
   for(unsigned int i = 0; i < fStep; i++)
     {
@@ -84,7 +112,7 @@ void TShower::GenerateShower()
   // Depth at shower maximum in unit of radiation length
   unsigned int index_max = 0;
   for(unsigned int i = 1; i < fStep; i++) if( fNe[i] > fNe[i-1] ) index_max = i;
-  fTmax = fT[index_max];  
+  fTmax = T[index_max];  
 
   // Status
   fStatus = true;
@@ -95,9 +123,8 @@ void TShower::GenerateShower()
 void TShower::GetLongitudinalProfile(vector<double> & T, vector<double> & Ne)
 {
   if( fStatus == false ) {cout << "Call TShower::GenerateShower first. EXITING." << endl; exit(0);}
-  T.resize(fStep);
-  Ne.resize(fStep);
-  for(unsigned int i = 0; i < fStep; i++) {T[i] = fT[i]; Ne[i] = fNe[i];}
+  T = *fT;
+  Ne = fNe;
 }
 
 
@@ -106,30 +133,49 @@ TGraph * TShower::GetLongitudinalProfile()
 {
   if( fStatus == false ) {cout << "Call TShower::GenerateShower first. EXITING." << endl; exit(0);}
   TGraph * gProfile = new TGraph(fStep);
-  for(unsigned int i = 0; i < fStep; i++) gProfile->SetPoint(i,fT[i],fNe[i]);
+  for(unsigned int i = 0; i < fStep; i++) gProfile->SetPoint(i,(*fT)[i],fNe[i]);
 
   return gProfile;
 }
 
 
 
-vector<double> Greisen(vector<double> & T, double energy)
+void SampleShowerVariates(uint64_t seed, uint64_t index, unsigned int size, double * T1, double * z)
 {
-  // Mean depth of shower maximum in unit of radiation length
-  double y = log(energy/Ec);
+  // Same draws in the same order as TShower::Init and TShower::GenerateShower
+  TRandomStream Random;
+  for(unsigned int i = 0; i < size; i++)
+    {
+      Random.SetSeed(seed,index+i);
+      // Depth of the first interaction
+      T1[i] = -Tint*log(Random.Rndm());
+      if( z ) z[i] = Random.Gaus();
+    }
+}
 
-  // Shower age
-  vector<double> age = depth2age(T,y);
 
-  // Number of electrons/positrons as a function of T
+
+vector<double> Greisen(vector<double> & T, double energy)
+{
   vector<double> Ne(T.size());
-  for(unsigned int i = 0; i < T.size(); i++) Ne[i] = (0.31/sqrt(y))*exp(T[i]*(1-1.5*log(age[i])));
+  if( !T.empty() ) Greisen(T.size(),&T[0],energy,&Ne[0]);
 
   return Ne;
 }
 
 
 
+void Greisen(unsigned int size, const double * T, double energy, double * Ne)
+{
+  // Mean depth of shower maximum in unit of radiation length
+  double y = log(energy/Ec);
+
+  // Number of electrons/positrons as a function of T
+  for(unsigned int i = 0; i < size; i++) Ne[i] = (0.31/sqrt(y))*exp(T[i]*(1-1.5*log(depth2age(T[i],y))));
+}
+
+
+
 double Greisen(double T, double energy)
 {
   // Mean depth of shower maximum in unit of radiation length
@@ -148,9 +194,17 @@ double Greisen(double T, double energy)
 
 vector<double> ElectronEnergySpectrum(vector<double> & energy, double age)
 {
-  // valid for electrons with energy > 1 MeV
-  unsigned int size = energy.size();
+  vector<double> spectrum(energy.size());
+  if( !energy.empty() ) ElectronEnergySpectrum(energy.size(),&energy[0],age,&spectrum[0]);
+
+  return spectrum;
+}
+
 
+
+void ElectronEnergySpectrum(unsigned int size, const double * energy, double age, double * spectrum)
+{
+  // valid for electrons with energy > 1 MeV
   double k0 = 0.145098;
   double k1 = 6.20114;
   double k2 = -0.596851;
@@ -159,11 +213,32 @@ vector<double> ElectronEnergySpectrum(vector<double> & energy, double age)
   double a2 = 168.168-42.1368*age;
   double a0 = k0*exp(k1*age+k2*age*age);
 
-  vector<double> spectrum(size);
   for(unsigned int i = 0; i < size; i++) spectrum[i] = a0*energy[i]/((energy[i]+a1)*pow(energy[i]+a2,age));
+}
 
-  vector<double> LogEnergy(size);
-  for(unsigned int i = 0; i < size; i++) LogEnergy[i] = log(energy[i]);
 
-  return spectrum;
+
+void ElectronEnergySpectrum(unsigned int size_energy, const double * energy, unsigned int size_age, const double * age, double * spectrum)
+{
+  // valid for electrons with energy > 1 MeV
+  double k0 = 0.145098;
+  double k1 = 6.20114;
+  double k2 = -0.596851;
+
+  double LogK0 = log(k0);
+  for(unsigned int i = 0; i < size_age; i++)
+    {
+      double s = age[i];
+      double a1 = 6.42522-1.53183*s;
+      double a2 = 168.168-42.1368*s;
+      double LogA0 = LogK0+k1*s+k2*s*s;
+
+      // a0*energy/((energy+a1)*(energy+a2)^s) = exp(log(a0)-s*log(energy+a2))*energy/(energy+a1)
+      double * row = spectrum+i*size_energy;
+      for(unsigned int j = 0; j < size_energy; j++) row[j] = energy[j]+a2;
+      VectorLog(size_energy,row,row);
+      for(unsigned int j = 0; j < size_energy; j++) row[j] = LogA0-s*row[j];
+      VectorExp(size_energy,row,row);
+      for(unsigned int j = 0; j < size_energy; j++) row[j] *= energy[j]/(energy[j]+a1);
+    }
 }
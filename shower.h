@@ -3,20 +3,32 @@
 
 #include <vector>
 #include <cstring>
+#include <memory>
 
-#include "TRandom3.h"
 #include "TGraph.h"
 
+#include "random.h"
+
 using namespace std;
 
 
+//! Depth grid in unit of radiation length, immutable and shared by all the showers with the same number of steps
+typedef shared_ptr<const vector<double> > TDepthGrid;
+
+//! Returns the depth grid of step values between 0.1 and 40 radiation lengths, built once per step (thread safe)
+TDepthGrid GetDepthGrid(unsigned int step);
+
+
 //! Shower generator
 class TShower
 {
   public :
-    //! Constructor
+    //! Constructor. The random stream is the next one of the run seed (see TRandomStream::NextIndex).
     TShower(double energy, double * coord, unsigned int step = 800);
 
+    //! Constructor with the random stream index of run seed, which fully determines the shower
+    TShower(double energy, double * coord, unsigned int step, uint64_t seed, uint64_t index);
+
     //! Destructor
     ~TShower();
 
@@ -29,6 +41,12 @@ class TShower
     //! Returns the zenith and azimuth angle of the incoming cosmic ray
     void GetIncomingDirection(double & theta, double & phi) const {theta = fTheta, phi = fPhi;}
 
+    //! Get #fSeed
+    uint64_t GetSeed() const {return fSeed;}
+
+    //! Get #fIndex
+    uint64_t GetIndex() const {return fIndex;}
+
     //! Get #fT1
     double GetT1() const {return fT1;}
     
@@ -41,6 +59,15 @@ class TShower
     //! Get #fTmax
     bool GetStatus() const {return fStatus;}
     
+    //! Get #fT
+    const vector<double> & GetDepth() const {return *fT;}
+
+    //! Get #fT, shared with all the showers of the same step
+    TDepthGrid GetDepthGrid() const {return fT;}
+
+    //! Get #fNe (empty until the shower is generated)
+    const vector<double> & GetNumberOfElectrons() const {return fNe;}
+
     //! Get the longitudinal profile of the EAS
     void GetLongitudinalProfile(vector<double> & T, vector<double> & Ne); 
 
@@ -52,7 +79,13 @@ class TShower
     void Init();
 
     //! Random generator
-    TRandom3 * fRandom;
+    TRandomStream fRandom;
+
+    //! Run seed of #fRandom
+    uint64_t fSeed;
+
+    //! Stream index of #fRandom
+    uint64_t fIndex;
 
     //! Energy in eV
     double fEnergy;
@@ -73,7 +106,7 @@ class TShower
     double fTmax;
     
     //! Number of radiation length
-    vector<double> fT;
+    TDepthGrid fT;
 
     //! Number of electrons/positrons
     vector<double> fNe;
@@ -83,6 +116,13 @@ class TShower
 };
 
 
+/*!
+  Draws the depth of the first interaction T1 (in unit of radiation length) and the Gaussian variate z of the profile
+  fluctuations of showers index, ..., index+size-1 of run seed without building them. These are exactly the values
+  the corresponding TShower(energy, coord, step, seed, index+i) would use. z may be 0 if not needed.
+ */
+void SampleShowerVariates(uint64_t seed, uint64_t index, unsigned int size, double * T1, double * z = 0);
+
 //! Mean longitudinal development of the electron/positron component of photon initiated electromagnetic EAS
 //! Greisen (1956)
 vector<double> Greisen(vector<double> & T, double energy);
@@ -91,10 +131,21 @@ vector<double> Greisen(vector<double> & T, double energy);
 //! Greisen (1956)
 double Greisen(double T, double energy);
 
+//! Same as above for the size values of T, written in Ne
+void Greisen(unsigned int size, const double * T, double energy, double * Ne);
+
 //! Electron energy spectrum between 1 MeV and 10 GeV in MeV
 //! Nerling et al. (2006)
 vector<double> ElectronEnergySpectrum(vector<double> & energy, double age);
 
+//! Same as above for the size values of energy, written in spectrum
+void ElectronEnergySpectrum(unsigned int size, const double * energy, double age, double * spectrum);
+
+//! Electron energy spectra between 1 MeV and 10 GeV in MeV for size_age ages at once
+//! spectrum[i*size_energy+j] is the spectrum at age[i] and energy[j] and must hold size_age*size_energy values
+//! Nerling et al. (2006)
+void ElectronEnergySpectrum(unsigned int size_energy, const double * energy, unsigned int size_age, const double * age, double * spectrum);
+
 
 
 #endif
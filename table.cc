@@ -0,0 +1,129 @@
+#include "table.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <stdint.h>
+
+
+
+namespace
+{
+  //! Binary header of the tables written by TTable2D::Save
+  struct TTable2DHeader
+  {
+    char fMagic[8];
+    uint32_t fNx;
+    uint32_t fNy;
+    double fXMin;
+    double fXMax;
+    double fYMin;
+    double fYMax;
+    double fKey[4];
+  };
+
+  const char kTable2DMagic[8] = {'T','A','B','L','E','2','D','1'};
+}
+
+
+
+TTable2D::TTable2D()
+{
+  SetGrid(2,0.,1.,2,0.,1.);
+  for(unsigned int i = 0; i < 4; i++) fKey[i] = 0.;
+  fFile = 0;
+  fData = 0;
+}
+
+
+
+TTable2D::TTable2D(unsigned int nx, double xMin, double xMax, unsigned int ny, double yMin, double yMax, const vector<double> & values)
+{
+  if( nx < 2 || ny < 2 || values.size() != nx*ny ) {cout << "ERROR: inconsistent table size. EXITING." << endl; exit(0);}
+  SetGrid(nx,xMin,xMax,ny,yMin,yMax);
+  for(unsigned int i = 0; i < 4; i++) fKey[i] = 0.;
+  fValues = values;
+  fFile = 0;
+  fData = &fValues[0];
+}
+
+
+
+TTable2D::~TTable2D()
+{
+  if( fFile ) delete fFile;
+}
+
+
+
+void TTable2D::SetKey(const double * key)
+{
+  for(unsigned int i = 0; i < 4; i++) fKey[i] = key[i];
+}
+
+
+
+void TTable2D::SetGrid(unsigned int nx, double xMin, double xMax, unsigned int ny, double yMin, double yMax)
+{
+  fNx = nx;
+  fXMin = xMin;
+  fXMax = xMax;
+  fInvDx = (nx-1.)/(xMax-xMin);
+  fNy = ny;
+  fYMin = yMin;
+  fYMax = yMax;
+  fInvDy = (ny-1.)/(yMax-yMin);
+}
+
+
+
+bool TTable2D::Save(string fileName) const
+{
+  if( !GetStatus() ) {cout << "Empty table, nothing written in " << fileName << "." << endl; return false;}
+
+  TTable2DHeader header;
+  memcpy(header.fMagic,kTable2DMagic,sizeof(kTable2DMagic));
+  header.fNx = fNx;
+  header.fNy = fNy;
+  header.fXMin = fXMin;
+  header.fXMax = fXMax;
+  header.fYMin = fYMin;
+  header.fYMax = fYMax;
+  for(unsigned int i = 0; i < 4; i++) header.fKey[i] = fKey[i];
+
+  ofstream tableFile(fileName.c_str(),ios::binary);
+  tableFile.write((const char *) &header,sizeof(header));
+  tableFile.write((const char *) fData,sizeof(double)*fNx*fNy);
+  tableFile.close();
+  if( !tableFile ) {cout << "Cannot write " << fileName << "." << endl; return false;}
+
+  return true;
+}
+
+
+
+bool TTable2D::Load(string fileName)
+{
+  TMappedFile * file = new TMappedFile(fileName);
+  if( !file->IsOpen() ) {delete file; return false;}
+
+  TTable2DHeader header;
+  if( file->GetSize() < sizeof(header) ) {cout << fileName << " is not a table." << endl; delete file; return false;}
+  memcpy(&header,file->GetData(),sizeof(header));
+  if( memcmp(header.fMagic,kTable2DMagic,sizeof(kTable2DMagic)) != 0 || header.fNx < 2 || header.fNy < 2 ||
+      file->GetSize() != sizeof(header)+sizeof(double)*header.fNx*header.fNy )
+    {
+      cout << fileName << " is not a table." << endl;
+      delete file;
+      return false;
+    }
+
+  if( fFile ) delete fFile;
+  fValues.clear();
+  fFile = file;
+  SetGrid(header.fNx,header.fXMin,header.fXMax,header.fNy,header.fYMin,header.fYMax);
+  SetKey(header.fKey);
+  fData = (const double *) (fFile->GetData()+sizeof(header));
+
+  return true;
+}
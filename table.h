@@ -0,0 +1,111 @@
+#ifndef _TABLE_H
+#define _TABLE_H
+
+#include <string>
+#include <vector>
+
+#include "mappedfile.h"
+
+using namespace std;
+
+
+
+/*!
+  Function of two variables tabulated on a regular (x, y) grid and evaluated by bilinear interpolation. The values
+  are stored row-major i.e. value (i,j) at x[i] and y[j] is at index i*ny+j. The table can be written to a binary
+  file and memory-mapped later on, in which case the values are read in place without any copy. Four user defined
+  numbers (#fKey) are saved along with the table so that one can make sure it matches the current setup.
+ */
+class TTable2D
+{
+  public :
+    //! Constructor of an empty table
+    TTable2D();
+
+    //! Constructor from the grid and the values (copied)
+    TTable2D(unsigned int nx, double xMin, double xMax, unsigned int ny, double yMin, double yMax, const vector<double> & values);
+
+    //! Destructor
+    ~TTable2D();
+
+    //! Sets #fKey
+    void SetKey(const double * key);
+
+    //! Returns #fKey
+    const double * GetKey() const {return fKey;}
+
+    //! Tells you whether the table holds values or not
+    bool GetStatus() const {return fData != 0;}
+
+    //! Tells you whether (x, y) lies within the grid
+    bool Contains(double x, double y) const {return x >= fXMin && x <= fXMax && y >= fYMin && y <= fYMax;}
+
+    //! Bilinear interpolation at (x, y). The point is assumed to lie within the grid.
+    double Interpolate(double x, double y) const
+    {
+      double u = (x-fXMin)*fInvDx;
+      double v = (y-fYMin)*fInvDy;
+      unsigned int i = (unsigned int) u;
+      unsigned int j = (unsigned int) v;
+      if( i > fNx-2 ) i = fNx-2;
+      if( j > fNy-2 ) j = fNy-2;
+      u -= i;
+      v -= j;
+      const double * row = fData+i*fNy+j;
+      return (1.-u)*((1.-v)*row[0]+v*row[1])+u*((1.-v)*row[fNy]+v*row[fNy+1]);
+    }
+
+    //! Writes the table in a binary file
+    bool Save(string fileName) const;
+
+    //! Memory-maps a table written by #Save
+    bool Load(string fileName);
+
+  private :
+    //! Not copyable
+    TTable2D(const TTable2D &);
+
+    //! Not assignable
+    TTable2D & operator=(const TTable2D &);
+
+    //! Sets the grid and the step inverses
+    void SetGrid(unsigned int nx, double xMin, double xMax, unsigned int ny, double yMin, double yMax);
+
+    //! Number of x values
+    unsigned int fNx;
+
+    //! Minimum x value
+    double fXMin;
+
+    //! Maximum x value
+    double fXMax;
+
+    //! Inverse of the x step
+    double fInvDx;
+
+    //! Number of y values
+    unsigned int fNy;
+
+    //! Minimum y value
+    double fYMin;
+
+    //! Maximum y value
+    double fYMax;
+
+    //! Inverse of the y step
+    double fInvDy;
+
+    //! User defined identification of the table
+    double fKey[4];
+
+    //! Values when the table is built in memory
+    vector<double> fValues;
+
+    //! Mapped file when the table is loaded
+    TMappedFile * fFile;
+
+    //! Values, either #fValues or a pointer into #fFile
+    const double * fData;
+};
+
+#endif
@@ -0,0 +1,166 @@
+#include "threadpool.h"
+
+
+
+TThreadPool::TThreadPool(unsigned int nThreads)
+{
+  if( nThreads == 0 ) nThreads = thread::hardware_concurrency();
+  if( nThreads == 0 ) nThreads = 1;
+
+  fTask = 0;
+  fGrain = 1;
+  fJob = 0;
+  fActive = 0;
+  fRemaining = 0;
+  fPushes = 0;
+  fIdle = 0;
+  fStop = false;
+
+  for(unsigned int i = 0; i < nThreads; i++) fQueues.push_back(new TWorkQueue());
+  for(unsigned int i = 0; i < nThreads; i++) fThreads.push_back(thread(&TThreadPool::Work,this,i));
+}
+
+
+
+TThreadPool::~TThreadPool()
+{
+  {
+    lock_guard<mutex> lock(fMutex);
+    fStop = true;
+  }
+  fStart.notify_all();
+  for(unsigned int i = 0; i < fThreads.size(); i++) fThreads[i].join();
+  for(unsigned int i = 0; i < fQueues.size(); i++) delete fQueues[i];
+}
+
+
+
+void TThreadPool::ParallelFor(unsigned int size, const function<void(unsigned int, unsigned int)> & task, unsigned int grain)
+{
+  if( size == 0 ) return;
+
+  // Each worker starts with a contiguous share of the range
+  unsigned int nThreads = fThreads.size();
+  for(unsigned int i = 0; i < nThreads; i++)
+    {
+      unsigned int first = (unsigned int) ((unsigned long long) size*i/nThreads);
+      unsigned int last = (unsigned int) ((unsigned long long) size*(i+1)/nThreads);
+      if( first == last ) continue;
+      lock_guard<mutex> lock(fQueues[i]->fMutex);
+      fQueues[i]->fRanges.push_back(TRange(first,last));
+    }
+
+  fTask = &task;
+  fGrain = grain > 0 ? grain : 1;
+  fRemaining = size;
+
+  unique_lock<mutex> lock(fMutex);
+  fActive = nThreads;
+  fJob++;
+  fStart.notify_all();
+  while( fActive > 0 ) fDone.wait(lock);
+  fTask = 0;
+}
+
+
+
+void TThreadPool::Work(unsigned int thread)
+{
+  unsigned long job = 0;
+  while( true )
+    {
+      {
+        unique_lock<mutex> lock(fMutex);
+        while( !fStop && fJob == job ) fStart.wait(lock);
+        if( fStop ) return;
+        job = fJob;
+      }
+
+      Run(thread);
+
+      lock_guard<mutex> lock(fMutex);
+      if( --fActive == 0 ) fDone.notify_all();
+    }
+}
+
+
+
+void TThreadPool::Run(unsigned int thread)
+{
+  TRange range;
+  while( fRemaining > 0 )
+    {
+      unsigned long pushes = fPushes;
+      if( !Pop(thread,range) && !Steal(thread,range) )
+        {
+          // Nothing to steal: sleep until a range is pushed after the search or the loop is done
+          unique_lock<mutex> lock(fIdleMutex);
+          fIdle++;
+          while( fPushes == pushes && fRemaining > 0 ) fWork.wait(lock);
+          fIdle--;
+          continue;
+        }
+
+      // Keep the lower part, leave the upper halves to be stolen
+      while( range.second-range.first > fGrain )
+        {
+          unsigned int middle = range.first+(range.second-range.first)/2;
+          Push(thread,TRange(middle,range.second));
+          range.second = middle;
+        }
+
+      for(unsigned int i = range.first; i < range.second; i++) (*fTask)(i,thread);
+      if( (fRemaining -= range.second-range.first) == 0 )
+        {
+          lock_guard<mutex> lock(fIdleMutex);
+          fWork.notify_all();
+        }
+    }
+}
+
+
+
+bool TThreadPool::Pop(unsigned int thread, TRange & range)
+{
+  TWorkQueue * queue = fQueues[thread];
+  lock_guard<mutex> lock(queue->fMutex);
+  if( queue->fRanges.empty() ) return false;
+  range = queue->fRanges.back();
+  queue->fRanges.pop_back();
+
+  return true;
+}
+
+
+
+void TThreadPool::Push(unsigned int thread, const TRange & range)
+{
+  {
+    lock_guard<mutex> lock(fQueues[thread]->fMutex);
+    fQueues[thread]->fRanges.push_back(range);
+  }
+
+  // A worker going to sleep counts itself in fIdle before checking fPushes, so one of them sees the other
+  fPushes++;
+  if( fIdle == 0 ) return;
+  lock_guard<mutex> lock(fIdleMutex);
+  fWork.notify_one();
+}
+
+
+
+bool TThreadPool::Steal(unsigned int thread, TRange & range)
+{
+  unsigned int nThreads = fQueues.size();
+  for(unsigned int i = 1; i < nThreads; i++)
+    {
+      TWorkQueue * queue = fQueues[(thread+i) % nThreads];
+      lock_guard<mutex> lock(queue->fMutex);
+      if( queue->fRanges.empty() ) continue;
+      range = queue->fRanges.front();
+      queue->fRanges.pop_front();
+      return true;
+    }
+
+  return false;
+}
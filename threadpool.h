@@ -0,0 +1,119 @@
+#ifndef _THREADPOOL_H
+#define _THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <utility>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+using namespace std;
+
+
+
+/*!
+  Pool of worker threads executing parallel loops with work stealing. Each worker starts with a contiguous share of
+  the index range in its own queue, splits it in halves down to the grain size and processes the lower half first.
+  Idle workers steal the largest remaining ranges from the other queues, so uneven tasks still keep every core busy.
+  A worker that finds nothing to steal sleeps until a range is split or the loop is done, instead of spinning.
+ */
+class TThreadPool
+{
+  public :
+    //! Constructor. Uses as many threads as hardware threads when nThreads = 0.
+    TThreadPool(unsigned int nThreads = 0);
+
+    //! Destructor. Joins the workers.
+    ~TThreadPool();
+
+    //! Returns the number of worker threads
+    unsigned int GetNumberOfThreads() const {return fThreads.size();}
+
+    /*!
+      Calls task(index, thread) for every index in [0,size) and returns once all of them are done. thread is the
+      number of the worker in [0,#GetNumberOfThreads) which allows per-thread scratch data. Not reentrant.
+     */
+    void ParallelFor(unsigned int size, const function<void(unsigned int, unsigned int)> & task, unsigned int grain = 1);
+
+  private :
+    //! Range of indices [first,second)
+    typedef pair<unsigned int, unsigned int> TRange;
+
+    //! Queue of ranges owned by a worker
+    struct TWorkQueue
+    {
+      mutex fMutex;
+      deque<TRange> fRanges;
+    };
+
+    //! Not copyable
+    TThreadPool(const TThreadPool &);
+
+    //! Not assignable
+    TThreadPool & operator=(const TThreadPool &);
+
+    //! Main loop of the workers
+    void Work(unsigned int thread);
+
+    //! Processes ranges until the current loop is done
+    void Run(unsigned int thread);
+
+    //! Takes the last range of the queue of thread
+    bool Pop(unsigned int thread, TRange & range);
+
+    //! Takes the first range of the queue of another thread
+    bool Steal(unsigned int thread, TRange & range);
+
+    //! Adds range to the queue of thread and wakes a sleeping worker to steal it
+    void Push(unsigned int thread, const TRange & range);
+
+    //! Workers
+    vector<thread> fThreads;
+
+    //! One queue per worker
+    vector<TWorkQueue *> fQueues;
+
+    //! Protects #fJob, #fActive and #fStop
+    mutex fMutex;
+
+    //! Signals a new loop or the end of the pool
+    condition_variable fStart;
+
+    //! Signals the end of a loop
+    condition_variable fDone;
+
+    //! Task of the current loop
+    const function<void(unsigned int, unsigned int)> * fTask;
+
+    //! Grain size of the current loop
+    unsigned int fGrain;
+
+    //! Number of the current loop
+    unsigned long fJob;
+
+    //! Number of workers still running the current loop
+    unsigned int fActive;
+
+    //! Number of indices not processed yet in the current loop
+    atomic<unsigned int> fRemaining;
+
+    //! Protects the sleep of the workers with nothing to steal
+    mutex fIdleMutex;
+
+    //! Signals a new range to steal or the end of the current loop
+    condition_variable fWork;
+
+    //! Number of ranges pushed by #Push, to tell whether one was pushed while looking for work
+    atomic<unsigned long> fPushes;
+
+    //! Number of workers sleeping on #fWork
+    atomic<unsigned int> fIdle;
+
+    //! Tells the workers to exit
+    bool fStop;
+};
+
+#endif
@@ -0,0 +1,222 @@
+#include "transmission.h"
+#include "common.h"
+#include "geometry.h"
+
+#include <cmath>
+#include <iostream>
+
+using namespace kMathConstants;
+
+
+
+namespace
+{
+  //! Rayleigh attenuation length at kRayleighWave in \f$ g . cm^{-2} \f$
+  const double kRayleighLength = 2970.;
+
+  //! Reference wavelength of kRayleighLength in cm
+  const double kRayleighWave = 400.e-7;
+}
+
+
+
+TTransmission::TTransmission(TAtmosphereHandle atmosphere, double waveMin, double waveMax, double groundAltitude)
+{
+  if( !(waveMax > waveMin) || waveMin <= 0. ) {cout << "ERROR: wrong wavelength range. EXITING." << endl; exit(0);}
+  fAtmosphere = atmosphere;
+  fWaveMin = waveMin;
+  fWaveMax = waveMax;
+  fGroundAltitude = groundAltitude;
+  fNAltitude = 0;
+  fNZenith = 0;
+  fNWave = 0;
+  fAltitudeMax = groundAltitude;
+  fZenithMax = 0.;
+  fSecantMax = 1.;
+  fBandTable = 0;
+  SetAerosol(0.04);
+}
+
+
+
+TTransmission::~TTransmission()
+{
+  if( fBandTable ) delete fBandTable;
+}
+
+
+
+void TTransmission::SetAerosol(double opticalDepth, double scaleHeight, double angstrom, double wave)
+{
+  fAerosolDepth = opticalDepth;
+  fAerosolHeight = scaleHeight;
+  fAngstrom = angstrom;
+  fAerosolWave = wave;
+}
+
+
+
+double TTransmission::ComputeTransmission(double altitude, double zenith, double wave) const
+{
+  if( altitude <= fGroundAltitude ) return 1.;
+
+  // Slant depth between the emission point and the ground, and air mass of the line of sight
+  TSlantGeometryHandle slant = GetSlantGeometry(fAtmosphere,zenith);
+  TSlantGeometryHandle vertical = GetSlantGeometry(fAtmosphere,0.);
+  double DeltaX = slant->GetSlantDepth(fGroundAltitude)-slant->GetSlantDepth(altitude);
+  double DeltaXv = vertical->GetSlantDepth(fGroundAltitude)-vertical->GetSlantDepth(altitude);
+  if( DeltaX < 0. ) DeltaX = 0.;
+  double AirMass = DeltaXv > 0. ? DeltaX/DeltaXv : 1./cos(zenith*DTOR);
+
+  double TauRayleigh = DeltaX/(kRayleighLength*pow(wave/kRayleighWave,4));
+  double TauMie = fAerosolDepth*pow(wave/fAerosolWave,-fAngstrom)*(1.-exp(-(altitude-fGroundAltitude)/fAerosolHeight))*AirMass;
+
+  return exp(-(TauRayleigh+TauMie));
+}
+
+
+
+void TTransmission::Build(unsigned int nAltitude, unsigned int nZenith, unsigned int nWave, double zenithMax)
+{
+  if( nAltitude < 2 || nZenith < 2 || nWave < 2 ) {cout << "ERROR: transmission table needs at least 2 points per axis. EXITING." << endl; exit(0);}
+  if( !(zenithMax > 0.) || !(zenithMax < 90.) ) {cout << "ERROR: maximum zenith angle of the transmission table must be in ]0,90[ degrees. EXITING." << endl; exit(0);}
+  fNAltitude = nAltitude;
+  fNZenith = nZenith;
+  fNWave = nWave;
+  fAltitudeMax = fAtmosphere->GetAltitude().back();
+  fZenithMax = zenithMax;
+  fSecantMax = 1./cos(zenithMax*DTOR);
+
+  // Zenith angles uniform in 1/cos
+  vector<double> altitude = Bins(nAltitude,fGroundAltitude,fAltitudeMax);
+  vector<double> zenith = Bins(nZenith,1.,fSecantMax);
+  for(unsigned int j = 0; j < nZenith; j++) zenith[j] = acos(1./zenith[j])/DTOR;
+  vector<double> wave = Bins(nWave,fWaveMin,fWaveMax);
+
+  // Wavelength dependence of both optical depths, and weights of the band average (Cherenkov spectrum in 1/lambda^2)
+  vector<double> RayleighScale(nWave), MieScale(nWave), weight(nWave);
+  Weights_nc5(nWave,wave[1]-wave[0],&weight[0]);
+  double norm = 0.;
+  for(unsigned int k = 0; k < nWave; k++)
+    {
+      RayleighScale[k] = 1./(kRayleighLength*pow(wave[k]/kRayleighWave,4));
+      MieScale[k] = fAerosolDepth*pow(wave[k]/fAerosolWave,-fAngstrom);
+      weight[k] /= pow(wave[k],2);
+      norm += weight[k];
+    }
+  for(unsigned int k = 0; k < nWave; k++) weight[k] /= norm;
+
+  // Vertical depth above the ground, for the air mass
+  TSlantGeometryHandle vertical = GetSlantGeometry(fAtmosphere,0.);
+  vector<double> DeltaXv(nAltitude);
+  for(unsigned int i = 0; i < nAltitude; i++) DeltaXv[i] = vertical->GetSlantDepth(fGroundAltitude)-vertical->GetSlantDepth(altitude[i]);
+
+  fTable.assign(nAltitude*nZenith*nWave,0.);
+  vector<double> band(nAltitude*nZenith,0.);
+  for(unsigned int j = 0; j < nZenith; j++)
+    {
+      // Built once here, not cached
+      TSlantGeometry slant(fAtmosphere,zenith[j]);
+      double GroundDepth = slant.GetSlantDepth(fGroundAltitude);
+      for(unsigned int i = 1; i < nAltitude; i++)
+        {
+          double DeltaX = GroundDepth-slant.GetSlantDepth(altitude[i]);
+          if( DeltaX < 0. ) DeltaX = 0.;
+          double AirMass = DeltaXv[i] > 0. ? DeltaX/DeltaXv[i] : 1./cos(zenith[j]*DTOR);
+          double profile = (1.-exp(-(altitude[i]-fGroundAltitude)/fAerosolHeight))*AirMass;
+
+          double * row = &fTable[(i*nZenith+j)*nWave];
+          double average = 0.;
+          for(unsigned int k = 0; k < nWave; k++)
+            {
+              row[k] = DeltaX*RayleighScale[k]+profile*MieScale[k];
+              average += weight[k]*exp(-row[k]);
+            }
+          band[i*nZenith+j] = -log(average);
+        }
+    }
+
+  if( fBandTable ) delete fBandTable;
+  fBandTable = new TTable2D(nAltitude,fGroundAltitude,fAltitudeMax,nZenith,1.,fSecantMax,band);
+}
+
+
+
+double TTransmission::Position(double x, double min, double max, unsigned int size)
+{
+  if( x <= min ) return 0.;
+  if( x >= max ) return size-1;
+  return (x-min)/(max-min)*(size-1);
+}
+
+
+
+double TTransmission::Secant(double zenith) const
+{
+  if( fabs(zenith) > fZenithMax )
+    {
+      cout << "ERROR: zenith angle " << zenith << " above the " << fZenithMax << " degrees of the transmission table. EXITING." << endl;
+      exit(0);
+    }
+
+  return 1./cos(zenith*DTOR);
+}
+
+
+
+double TTransmission::GetTransmission(double altitude, double zenith, double wave) const
+{
+  if( fTable.empty() ) {cout << "ERROR: transmission table not built. EXITING." << endl; exit(0);}
+
+  double u = Position(altitude,fGroundAltitude,fAltitudeMax,fNAltitude);
+  double v = Position(Secant(zenith),1.,fSecantMax,fNZenith);
+  double w = Position(wave,fWaveMin,fWaveMax,fNWave);
+  unsigned int i = (unsigned int) u, j = (unsigned int) v, k = (unsigned int) w;
+  if( i > fNAltitude-2 ) i = fNAltitude-2;
+  if( j > fNZenith-2 ) j = fNZenith-2;
+  if( k > fNWave-2 ) k = fNWave-2;
+  u -= i;
+  v -= j;
+  w -= k;
+
+  // Trilinear interpolation of the optical depth
+  const double * c00 = &fTable[(i*fNZenith+j)*fNWave+k];
+  const double * c01 = c00+fNWave;
+  const double * c10 = c00+fNZenith*fNWave;
+  const double * c11 = c10+fNWave;
+  double t00 = c00[0]+w*(c00[1]-c00[0]), t01 = c01[0]+w*(c01[1]-c01[0]);
+  double t10 = c10[0]+w*(c10[1]-c10[0]), t11 = c11[0]+w*(c11[1]-c11[0]);
+
+  return exp(-((1.-u)*((1.-v)*t00+v*t01)+u*((1.-v)*t10+v*t11)));
+}
+
+
+
+double TTransmission::GetBandTransmission(double altitude, double zenith) const
+{
+  if( !fBandTable ) {cout << "ERROR: transmission table not built. EXITING." << endl; exit(0);}
+
+  double secant = Secant(zenith);
+  if( secant > fSecantMax ) secant = fSecantMax; // rounding at zenithMax
+  if( altitude < fGroundAltitude ) altitude = fGroundAltitude;
+  if( altitude > fAltitudeMax ) altitude = fAltitudeMax;
+
+  return exp(-fBandTable->Interpolate(altitude,secant));
+}
+
+
+
+void TTransmission::GetBandTransmission(unsigned int size, const double * altitude, double zenith, double * transmission) const
+{
+  if( !fBandTable ) {cout << "ERROR: transmission table not built. EXITING." << endl; exit(0);}
+
+  double secant = Secant(zenith);
+  if( secant > fSecantMax ) secant = fSecantMax;
+  for(unsigned int i = 0; i < size; i++)
+    {
+      double h = altitude[i];
+      if( h < fGroundAltitude ) h = fGroundAltitude;
+      if( h > fAltitudeMax ) h = fAltitudeMax;
+      transmission[i] = exp(-fBandTable->Interpolate(h,secant));
+    }
+}
@@ -0,0 +1,129 @@
+#ifndef _TRANSMISSION_H
+#define _TRANSMISSION_H
+
+#include <vector>
+#include <memory>
+
+#include "atmosphere.h"
+#include "table.h"
+
+using namespace std;
+
+
+
+/*!
+  Transmission of Cherenkov light from its emission altitude down to the ground, along a line of sight of given
+  zenith angle. Two processes are included:
+  - Rayleigh scattering on the air molecules, with the optical depth \f$ \Delta X / X_R \f$, where \f$ \Delta X \f$
+    is the slant depth between the emission point and the ground (see TSlantGeometry) and
+    \f$ X_R = 2970 (\lambda / 400 nm)^4 g . cm^{-2} \f$.
+  - Mie scattering on aerosols, with a vertical optical depth \f$ \tau_0 (\lambda / \lambda_0)^{-\alpha} \f$ above the
+    ground distributed with a scale height H. Its slant optical depth scales with the air mass of the line of sight.
+
+  The line-of-sight integrals are done once by #Build on a (altitude, zenith, wavelength) grid, together with the
+  transmission averaged over the wavelength band weighted by the Cherenkov spectrum in \f$ 1/\lambda^2 \f$. Each
+  transmission is then a table lookup. The tables hold optical depths, which are much closer to linear than the
+  transmission itself between the nodes. The zenith angles of the tables are uniform in \f$ 1/\cos\theta \f$, in which
+  the optical depth is linear for a flat atmosphere, so the nodes get denser towards the horizon where it grows fast.
+ */
+class TTransmission
+{
+  public :
+    //! Constructor. waveMin and waveMax in cm, groundAltitude in km.
+    TTransmission(TAtmosphereHandle atmosphere, double waveMin, double waveMax, double groundAltitude = 0.);
+
+    //! Destructor
+    ~TTransmission();
+
+    /*!
+      Aerosol model: vertical optical depth above the ground at wavelength wave (in cm), scale height in km and
+      Angstrom exponent. The default is an optical depth of 0.04 at 350 nm, a scale height of 1.2 km and an exponent
+      of 1. Set opticalDepth to 0 to remove the aerosols. Call #Build afterwards.
+     */
+    void SetAerosol(double opticalDepth, double scaleHeight = 1.2, double angstrom = 1., double wave = 350.e-7);
+
+    /*!
+      Tabulates the transmission over nAltitude altitudes, nZenith zenith angles in [0,zenithMax] degrees (zenithMax
+      below 90) and nWave wavelengths
+     */
+    void Build(unsigned int nAltitude = 201, unsigned int nZenith = 41, unsigned int nWave = 21, double zenithMax = 89.);
+
+    //! Tells you whether the tables are built or not
+    bool GetStatus() const {return !fTable.empty();}
+
+    //! Returns #fGroundAltitude
+    double GetGroundAltitude() const {return fGroundAltitude;}
+
+    /*!
+      Transmission from altitude (km) to the ground along zenith (degrees) at wave (cm), interpolated in the table.
+      Altitudes and wavelengths outside of the table are clamped to it, zenith angles above the zenithMax of #Build are
+      an error.
+     */
+    double GetTransmission(double altitude, double zenith, double wave) const;
+
+    //! Transmission averaged over the wavelength band, interpolated in the table (same range as above)
+    double GetBandTransmission(double altitude, double zenith) const;
+
+    //! Same as above for the size altitudes, written in transmission
+    void GetBandTransmission(unsigned int size, const double * altitude, double zenith, double * transmission) const;
+
+    //! Transmission computed without the tables (line-of-sight integral)
+    double ComputeTransmission(double altitude, double zenith, double wave) const;
+
+  private :
+    //! Not copyable
+    TTransmission(const TTransmission &);
+
+    //! Not assignable
+    TTransmission & operator=(const TTransmission &);
+
+    //! Clamps x in [min,max] and returns its position in units of the step of a grid of size points
+    static double Position(double x, double min, double max, unsigned int size);
+
+    //! 1/cos(zenith), the zenith coordinate of the tables. Exits above #fZenithMax.
+    double Secant(double zenith) const;
+
+    //! Atmosphere
+    TAtmosphereHandle fAtmosphere;
+
+    //! Minimum wavelength in cm
+    double fWaveMin;
+
+    //! Maximum wavelength in cm
+    double fWaveMax;
+
+    //! Altitude of the ground in km
+    double fGroundAltitude;
+
+    //! Vertical aerosol optical depth above the ground at #fAerosolWave
+    double fAerosolDepth;
+
+    //! Aerosol scale height in km
+    double fAerosolHeight;
+
+    //! Angstrom exponent of the aerosol optical depth
+    double fAngstrom;
+
+    //! Reference wavelength of #fAerosolDepth in cm
+    double fAerosolWave;
+
+    //! Number of altitudes, zenith angles and wavelengths of the table
+    unsigned int fNAltitude, fNZenith, fNWave;
+
+    //! Highest altitude (km) and zenith angle (degrees) of the table
+    double fAltitudeMax, fZenithMax;
+
+    //! 1/cos(#fZenithMax)
+    double fSecantMax;
+
+    //! Optical depth at (altitude i, zenith j, wavelength k), at index (i*#fNZenith+j)*#fNWave+k, zenith uniform in 1/cos
+    vector<double> fTable;
+
+    //! Minus the logarithm of the transmission averaged over the band (altitude, 1/cos(zenith))
+    TTable2D * fBandTable;
+};
+
+//! Shared read-only transmission tables
+typedef shared_ptr<const TTransmission> TTransmissionHandle;
+
+#endif
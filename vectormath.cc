@@ -0,0 +1,167 @@
+#include "vectormath.h"
+
+#include <cstring>
+#include <stdint.h>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__AVX512F__) && defined(__GNUC__) && !defined(__clang__)
+// GCC flags _mm512_undefined_pd() inside its own AVX-512 intrinsics
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+
+
+namespace
+{
+  /* Exponential: exp(x) = 2^k exp(r) with k = round(x/ln2) and |r| <= ln2/2. exp(r) is a degree 13 Taylor polynomial. */
+  const double kExpMin = -708.;
+  const double kExpMax = 709.;
+  const double kLog2e = 1.4426950408889634074;
+  const double kLn2Hi = 6.93147180369123816490e-01;
+  const double kLn2Lo = 1.90821492927058770002e-10;
+  const unsigned int kExpDegree = 13;
+  const double kExpCoefficients[kExpDegree+1] = // 1/n! from n = 13 down to 0
+    {1.6059043836821614599e-10, 2.0876756987868098979e-09, 2.5052108385441718775e-08, 2.7557319223985890653e-07,
+     2.7557319223985890653e-06, 2.4801587301587301587e-05, 1.9841269841269841270e-04, 1.3888888888888888889e-03,
+     8.3333333333333333333e-03, 4.1666666666666666667e-02, 1.6666666666666666667e-01, 5.0000000000000000000e-01,
+     1.0, 1.0};
+
+  /* Logarithm: log(x) = e ln2 + log(m) with m in [sqrt(2)/2, sqrt(2)]. log(m) = 2 atanh(s) with s = (m-1)/(m+1). */
+  const double kSqrt2 = 1.41421356237309504880;
+  const double kLn2 = 6.93147180559945309417e-01;
+  const unsigned int kLogDegree = 10;
+  const double kLogCoefficients[kLogDegree+1] = // 2/(2n+1) from n = 10 down to 0
+    {2./21., 2./19., 2./17., 2./15., 2./13., 2./11., 2./9., 2./7., 2./5., 2./3., 2.};
+
+  inline double ScalarExp(double x)
+  {
+    if( x < kExpMin ) x = kExpMin;
+    if( x > kExpMax ) x = kExpMax;
+    double k = x*kLog2e;
+    k = (double) (int64_t) (k < 0. ? k-0.5 : k+0.5);
+    double r = (x-k*kLn2Hi)-k*kLn2Lo;
+    double p = kExpCoefficients[0];
+    for(unsigned int i = 1; i <= kExpDegree; i++) p = p*r+kExpCoefficients[i];
+    uint64_t bits = (uint64_t) ((int64_t) k+1023) << 52;
+    double scale;
+    memcpy(&scale,&bits,sizeof(scale));
+    return p*scale;
+  }
+
+  inline double ScalarLog(double x)
+  {
+    uint64_t bits;
+    memcpy(&bits,&x,sizeof(bits));
+    double e = (double) ((int64_t) (bits >> 52)-1023);
+    bits = (bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL;
+    double m;
+    memcpy(&m,&bits,sizeof(m));
+    if( m > kSqrt2 ) {m *= 0.5; e += 1.;}
+    double s = (m-1.)/(m+1.);
+    double z = s*s;
+    double p = kLogCoefficients[0];
+    for(unsigned int i = 1; i <= kLogDegree; i++) p = p*z+kLogCoefficients[i];
+    return e*kLn2+s*p;
+  }
+
+#if defined(__AVX512F__)
+  inline __m512d VectorExp8(__m512d x)
+  {
+    x = _mm512_min_pd(_mm512_max_pd(x,_mm512_set1_pd(kExpMin)),_mm512_set1_pd(kExpMax));
+    __m512d k = _mm512_roundscale_pd(_mm512_mul_pd(x,_mm512_set1_pd(kLog2e)),_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512d r = _mm512_fnmadd_pd(k,_mm512_set1_pd(kLn2Hi),x);
+    r = _mm512_fnmadd_pd(k,_mm512_set1_pd(kLn2Lo),r);
+    __m512d p = _mm512_set1_pd(kExpCoefficients[0]);
+    for(unsigned int i = 1; i <= kExpDegree; i++) p = _mm512_fmadd_pd(p,r,_mm512_set1_pd(kExpCoefficients[i]));
+    return _mm512_scalef_pd(p,k);
+  }
+
+  inline __m512d VectorLog8(__m512d x)
+  {
+    __m512d e = _mm512_getexp_pd(x);
+    __m512d m = _mm512_getmant_pd(x,_MM_MANT_NORM_1_2,_MM_MANT_SIGN_src);
+    __mmask8 large = _mm512_cmp_pd_mask(m,_mm512_set1_pd(kSqrt2),_CMP_GT_OQ);
+    m = _mm512_mask_mul_pd(m,large,m,_mm512_set1_pd(0.5));
+    e = _mm512_mask_add_pd(e,large,e,_mm512_set1_pd(1.));
+    __m512d one = _mm512_set1_pd(1.);
+    __m512d s = _mm512_div_pd(_mm512_sub_pd(m,one),_mm512_add_pd(m,one));
+    __m512d z = _mm512_mul_pd(s,s);
+    __m512d p = _mm512_set1_pd(kLogCoefficients[0]);
+    for(unsigned int i = 1; i <= kLogDegree; i++) p = _mm512_fmadd_pd(p,z,_mm512_set1_pd(kLogCoefficients[i]));
+    return _mm512_fmadd_pd(e,_mm512_set1_pd(kLn2),_mm512_mul_pd(s,p));
+  }
+#elif defined(__AVX2__)
+  inline __m256d MultiplyAdd(__m256d a, __m256d b, __m256d c)
+  {
+#if defined(__FMA__)
+    return _mm256_fmadd_pd(a,b,c);
+#else
+    return _mm256_add_pd(_mm256_mul_pd(a,b),c);
+#endif
+  }
+
+  inline __m256d VectorExp4(__m256d x)
+  {
+    x = _mm256_min_pd(_mm256_max_pd(x,_mm256_set1_pd(kExpMin)),_mm256_set1_pd(kExpMax));
+    __m256d k = _mm256_round_pd(_mm256_mul_pd(x,_mm256_set1_pd(kLog2e)),_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_sub_pd(x,_mm256_mul_pd(k,_mm256_set1_pd(kLn2Hi)));
+    r = _mm256_sub_pd(r,_mm256_mul_pd(k,_mm256_set1_pd(kLn2Lo)));
+    __m256d p = _mm256_set1_pd(kExpCoefficients[0]);
+    for(unsigned int i = 1; i <= kExpDegree; i++) p = MultiplyAdd(p,r,_mm256_set1_pd(kExpCoefficients[i]));
+    // 2^k: k lands in the low bits of the mantissa once shifted by 1.5 2^52
+    __m256i ki = _mm256_castpd_si256(_mm256_add_pd(k,_mm256_set1_pd(6755399441055744.)));
+    ki = _mm256_slli_epi64(_mm256_add_epi64(ki,_mm256_set1_epi64x(1023)),52);
+    return _mm256_mul_pd(p,_mm256_castsi256_pd(ki));
+  }
+
+  inline __m256d VectorLog4(__m256d x)
+  {
+    __m256i bits = _mm256_castpd_si256(x);
+    // Biased exponent as a double: put it in the mantissa of 2^52 and subtract 2^52
+    __m256i biased = _mm256_srli_epi64(bits,52);
+    __m256d two52 = _mm256_set1_pd(4503599627370496.);
+    __m256d e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(biased,_mm256_castpd_si256(two52))),two52);
+    e = _mm256_sub_pd(e,_mm256_set1_pd(1023.));
+    __m256i mantissa = _mm256_and_si256(bits,_mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL));
+    __m256d m = _mm256_castsi256_pd(_mm256_or_si256(mantissa,_mm256_set1_epi64x(0x3FF0000000000000LL)));
+    __m256d large = _mm256_cmp_pd(m,_mm256_set1_pd(kSqrt2),_CMP_GT_OQ);
+    m = _mm256_blendv_pd(m,_mm256_mul_pd(m,_mm256_set1_pd(0.5)),large);
+    e = _mm256_add_pd(e,_mm256_and_pd(large,_mm256_set1_pd(1.)));
+    __m256d one = _mm256_set1_pd(1.);
+    __m256d s = _mm256_div_pd(_mm256_sub_pd(m,one),_mm256_add_pd(m,one));
+    __m256d z = _mm256_mul_pd(s,s);
+    __m256d p = _mm256_set1_pd(kLogCoefficients[0]);
+    for(unsigned int i = 1; i <= kLogDegree; i++) p = MultiplyAdd(p,z,_mm256_set1_pd(kLogCoefficients[i]));
+    return MultiplyAdd(e,_mm256_set1_pd(kLn2),_mm256_mul_pd(s,p));
+  }
+#endif
+}
+
+
+
+void VectorExp(unsigned int size, const double * x, double * y)
+{
+  unsigned int i = 0;
+#if defined(__AVX512F__)
+  for(; i+8 <= size; i += 8) _mm512_storeu_pd(y+i,VectorExp8(_mm512_loadu_pd(x+i)));
+#elif defined(__AVX2__)
+  for(; i+4 <= size; i += 4) _mm256_storeu_pd(y+i,VectorExp4(_mm256_loadu_pd(x+i)));
+#endif
+  for(; i < size; i++) y[i] = ScalarExp(x[i]);
+}
+
+
+
+void VectorLog(unsigned int size, const double * x, double * y)
+{
+  unsigned int i = 0;
+#if defined(__AVX512F__)
+  for(; i+8 <= size; i += 8) _mm512_storeu_pd(y+i,VectorLog8(_mm512_loadu_pd(x+i)));
+#elif defined(__AVX2__)
+  for(; i+4 <= size; i += 4) _mm256_storeu_pd(y+i,VectorLog4(_mm256_loadu_pd(x+i)));
+#endif
+  for(; i < size; i++) y[i] = ScalarLog(x[i]);
+}
@@ -0,0 +1,16 @@
+#ifndef _VECTORMATH_H
+#define _VECTORMATH_H
+
+/*!
+  Vectorized exponential and natural logarithm of arrays. The AVX-512 or AVX2 kernel is selected at compile time
+  (see ARCHFLAGS in the makefile), otherwise a scalar implementation of the very same polynomial approximations is
+  used. The relative accuracy is a few \f$ 10^{-16} \f$ in all cases.
+ */
+
+//! y[i] = exp(x[i]), x is clamped to [-708,709]. x and y may be the same array.
+void VectorExp(unsigned int size, const double * x, double * y);
+
+//! y[i] = log(x[i]) for positive and finite x[i]. x and y may be the same array.
+void VectorLog(unsigned int size, const double * x, double * y);
+
+#endif
@@ -0,0 +1,113 @@
+#include "workspace.h"
+
+#include <cstdlib>
+#include <iostream>
+
+//! Alignment of the buffers in bytes
+static const size_t kAlignment = 64;
+
+//! Size of the first block in bytes
+static const size_t kFirstBlockSize = 1 << 16;
+
+
+
+//! New block of size bytes (a multiple of kAlignment)
+static char * NewBlock(size_t size)
+{
+  char * data = (char *) aligned_alloc(kAlignment,size);
+  if( !data ) {cout << "Cannot allocate " << size << " bytes of workspace. EXITING." << endl; exit(0);}
+
+  return data;
+}
+
+
+
+TWorkspace::TWorkspace()
+{
+  fBlock = 0;
+  fOffset = 0;
+  fUsed = 0;
+  fHighWater = 0;
+}
+
+
+
+TWorkspace::~TWorkspace()
+{
+  for(unsigned int i = 0; i < fBlocks.size(); i++) free(fBlocks[i].fData);
+}
+
+
+
+size_t TWorkspace::GetCapacity() const
+{
+  size_t capacity = 0;
+  for(unsigned int i = 0; i < fBlocks.size(); i++) capacity += fBlocks[i].fSize;
+
+  return capacity;
+}
+
+
+
+TWorkspace & TWorkspace::GetThreadWorkspace()
+{
+  static thread_local TWorkspace workspace;
+
+  return workspace;
+}
+
+
+
+void * TWorkspace::AllocateBytes(size_t size)
+{
+  size = (size+kAlignment-1)/kAlignment*kAlignment;
+  if( size == 0 ) size = kAlignment;
+
+  if( fBlocks.empty() || fOffset+size > fBlocks[fBlock].fSize )
+    {
+      // The current block is full: move to the next one, replacing the following blocks if they are too small
+      unsigned int next = fBlocks.empty() ? 0 : fBlock+1;
+      if( next < fBlocks.size() && fBlocks[next].fSize < size )
+        {
+          for(unsigned int i = next; i < fBlocks.size(); i++) free(fBlocks[i].fData);
+          fBlocks.resize(next);
+        }
+      if( next == fBlocks.size() )
+        {
+          TBlock block;
+          block.fSize = fBlocks.empty() ? kFirstBlockSize : 2*fBlocks.back().fSize;
+          if( block.fSize < size ) block.fSize = size;
+          block.fData = NewBlock(block.fSize);
+          fBlocks.push_back(block);
+        }
+      fBlock = next;
+      fOffset = 0;
+    }
+
+  void * buffer = fBlocks[fBlock].fData+fOffset;
+  fOffset += size;
+  fUsed += size;
+  if( fUsed > fHighWater ) fHighWater = fUsed;
+
+  return buffer;
+}
+
+
+
+void TWorkspace::Release(size_t used, unsigned int block, size_t offset)
+{
+  fUsed = used;
+  fBlock = block;
+  fOffset = offset;
+
+  // Once empty, the blocks are merged in a single one holding the largest computation seen so far
+  if( fUsed == 0 && fBlocks.size() > 1 )
+    {
+      for(unsigned int i = 0; i < fBlocks.size(); i++) free(fBlocks[i].fData);
+      fBlocks.resize(1);
+      fBlocks[0].fSize = fHighWater;
+      fBlocks[0].fData = NewBlock(fHighWater);
+      fBlock = 0;
+      fOffset = 0;
+    }
+}
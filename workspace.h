@@ -0,0 +1,114 @@
+#ifndef _WORKSPACE_H
+#define _WORKSPACE_H
+
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+
+
+/*!
+  Scratch memory of a thread, allocated as a stack. Buffers are taken with #Allocate and given back all at once
+  when the enclosing TWorkspaceFrame goes out of scope. The memory is kept from one computation to the next: once
+  the workspace has grown to the largest computation, it does not allocate anymore. Buffers are aligned on 64
+  bytes and are not initialized, so only plain types (double, unsigned int, pointers) may be stored.
+ */
+class TWorkspace
+{
+  public :
+    //! Constructor of an empty workspace
+    TWorkspace();
+
+    //! Destructor
+    ~TWorkspace();
+
+    //! Buffer of size values, valid until the enclosing frame is released
+    template <typename Type> Type * Allocate(size_t size) {return (Type *) AllocateBytes(size*sizeof(Type));}
+
+    //! Returns the number of bytes currently allocated
+    size_t GetUsed() const {return fUsed;}
+
+    //! Returns the total number of bytes reserved
+    size_t GetCapacity() const;
+
+    //! Returns the number of blocks reserved, one once the workspace has settled
+    unsigned int GetNumberOfBlocks() const {return fBlocks.size();}
+
+    //! Workspace of the calling thread
+    static TWorkspace & GetThreadWorkspace();
+
+  private :
+    friend class TWorkspaceFrame;
+
+    //! Memory block
+    struct TBlock
+    {
+      char * fData;
+      size_t fSize;
+    };
+
+    //! Not copyable
+    TWorkspace(const TWorkspace &);
+
+    //! Not assignable
+    TWorkspace & operator=(const TWorkspace &);
+
+    //! Buffer of size bytes on top of the stack
+    void * AllocateBytes(size_t size);
+
+    //! Gives back everything allocated after used bytes. Merges the blocks once the workspace is empty.
+    void Release(size_t used, unsigned int block, size_t offset);
+
+    //! Memory blocks, a new one being added when the current one is full
+    vector<TBlock> fBlocks;
+
+    //! Current block
+    unsigned int fBlock;
+
+    //! Top of the stack in the current block
+    size_t fOffset;
+
+    //! Number of bytes allocated
+    size_t fUsed;
+
+    //! Largest number of bytes allocated at once, including alignment
+    size_t fHighWater;
+};
+
+
+
+/*!
+  Scope of the buffers taken from a workspace: everything allocated after the construction of the frame is given
+  back to the workspace by its destructor. Frames may be nested.
+ */
+class TWorkspaceFrame
+{
+  public :
+    //! Constructor
+    TWorkspaceFrame(TWorkspace & workspace = TWorkspace::GetThreadWorkspace())
+      : fWorkspace(workspace), fUsed(workspace.fUsed), fBlock(workspace.fBlock), fOffset(workspace.fOffset) {}
+
+    //! Destructor. Releases the buffers of the frame.
+    ~TWorkspaceFrame() {fWorkspace.Release(fUsed,fBlock,fOffset);}
+
+    //! Buffer of size values taken from the workspace
+    template <typename Type> Type * Allocate(size_t size) {return fWorkspace.Allocate<Type>(size);}
+
+  private :
+    //! Not copyable
+    TWorkspaceFrame(const TWorkspaceFrame &);
+
+    //! Not assignable
+    TWorkspaceFrame & operator=(const TWorkspaceFrame &);
+
+    //! Workspace
+    TWorkspace & fWorkspace;
+
+    //! State of the workspace at the construction
+    size_t fUsed;
+    unsigned int fBlock;
+    size_t fOffset;
+};
+
+#endif
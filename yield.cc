@@ -0,0 +1,155 @@
+#include "yield.h"
+#include "common.h"
+
+#include <iostream>
+
+using namespace kMathConstants;
+using namespace kPhysicalConstants;
+
+
+
+TCherenkovYield::TCherenkovYield(double waveMin, double waveMax)
+{
+  fWaveMin = waveMin; // in cm
+  fWaveMax = waveMax; // in cm
+
+  // Flat efficiency: the integral is analytical
+  fBandIntegral = 1./fWaveMin-1./fWaveMax;
+
+  Init();
+}
+
+
+
+TCherenkovYield::TCherenkovYield(double waveMin, double waveMax, const vector<double> & wave, const vector<double> & efficiency)
+{
+  fWaveMin = waveMin; // in cm
+  fWaveMax = waveMax; // in cm
+
+  // The efficiency is linearly interpolated and vanishes outside of the tabulated range
+  fWave = wave;
+  fEfficiency = efficiency;
+  unsigned int size = 1001;
+  vector<double> wave_band = Bins(size, fWaveMin, fWaveMax);
+  vector<double> efficiency_band = Interpol(wave, efficiency, wave_band);
+  vector<double> integrand(size);
+  for(unsigned int i = 0; i < size; i++)
+    {
+      if( wave_band[i] < wave.front() || wave_band[i] > wave.back() || efficiency_band[i] < 0. ) efficiency_band[i] = 0.;
+      integrand[i] = efficiency_band[i]/pow(wave_band[i],2);
+    }
+  fBandIntegral = Integrate_nc5(wave_band,integrand);
+
+  Init();
+}
+
+
+
+void TCherenkovYield::Init()
+{
+  fMe = Me;
+  fMe2 = Me*Me;
+  fFactor = TwoPi*alpha*fBandIntegral;
+}
+
+
+
+double TCherenkovYield::Efficiency(double wave) const
+{
+  if( wave < fWaveMin || wave > fWaveMax ) return 0.;
+  if( fWave.empty() ) return 1.;
+  if( wave < fWave.front() || wave > fWave.back() ) return 0.;
+
+  double efficiency = Interpol(fWave,fEfficiency,wave);
+  return efficiency > 0. ? efficiency : 0.;
+}
+
+
+
+double RefractivityRatio(double wave, double waveReference)
+{
+  // (n-1)*1e8 of standard air, sigma being the wavenumber in inverse microns
+  double sigma2 = pow(1.e-4/wave,2), sigma2_ref = pow(1.e-4/waveReference,2);
+  double refractivity = 8342.13+2406030./(130.-sigma2)+15997./(38.9-sigma2);
+  double refractivity_ref = 8342.13+2406030./(130.-sigma2_ref)+15997./(38.9-sigma2_ref);
+
+  return refractivity/refractivity_ref;
+}
+
+
+
+TSpectralYield::TSpectralYield(const TCherenkovYield & yield, unsigned int nBins)
+{
+  Init(yield,nBins,vector<double>(),vector<double>());
+}
+
+
+
+TSpectralYield::TSpectralYield(const TCherenkovYield & yield, unsigned int nBins, const vector<double> & wave, const vector<double> & ratio)
+{
+  if( wave.size() < 2 || wave.size() != ratio.size() ) {cout << "ERROR: inconsistent dispersion table. EXITING." << endl; exit(0);}
+  Init(yield,nBins,wave,ratio);
+}
+
+
+
+void TSpectralYield::Init(const TCherenkovYield & yield, unsigned int nBins, const vector<double> & wave, const vector<double> & ratio)
+{
+  if( nBins == 0 ) {cout << "ERROR: no wavelength bin. EXITING." << endl; exit(0);}
+
+  double width = (yield.GetWaveMax()-yield.GetWaveMin())/nBins;
+  double weight[kSamples];
+  Weights_nc5(kSamples,width/(kSamples-1),weight);
+
+  fWave.resize(nBins);
+  fRatio.resize(nBins*kSamples);
+  fLogThresholdShift.resize(nBins*kSamples);
+  fWeight.resize(nBins*kSamples);
+  for(unsigned int k = 0; k < nBins; k++)
+    {
+      double WaveLow = yield.GetWaveMin()+k*width;
+      fWave[k] = WaveLow+0.5*width;
+      for(unsigned int s = 0; s < kSamples; s++)
+        {
+          unsigned int m = k*kSamples+s;
+          double lambda = WaveLow+s*width/(kSamples-1);
+          fRatio[m] = wave.empty() ? RefractivityRatio(lambda) : Interpol(wave,ratio,lambda);
+          fLogThresholdShift[m] = -0.5*log(fRatio[m]);
+          fWeight[m] = TwoPi*alpha*yield.Efficiency(lambda)/pow(lambda,2)*weight[s];
+        }
+    }
+}
+
+
+
+void TSpectralYield::Yield(unsigned int size, double logEnergyMin, double step, const double * tail0, const double * tail2,
+                           double delta, double density, double * photons) const
+{
+  // Logarithm of the energy threshold without dispersion, in units of step from the first energy
+  double u0 = (log(Me/sqrt(2.*delta))-logEnergyMin)/step;
+  double InvStep = 1./step, Me2 = Me*Me;
+
+  unsigned int nBins = fWave.size();
+  for(unsigned int k = 0; k < nBins; k++)
+    {
+      double sum = 0.;
+      for(unsigned int m = k*kSamples; m < (k+1)*kSamples; m++)
+        {
+          // Tails above the threshold at this wavelength, linearly interpolated in log(energy)
+          double u = u0+fLogThresholdShift[m]*InvStep;
+          double A, B;
+          if( u <= 0. ) {A = tail0[0]; B = tail2[0];}
+          else if( u >= size-1 ) continue;
+          else
+            {
+              unsigned int j = (unsigned int) u;
+              double f = u-j;
+              A = tail0[j]+f*(tail0[j+1]-tail0[j]);
+              B = tail2[j]+f*(tail2[j+1]-tail2[j]);
+            }
+          double value = 2.*delta*fRatio[m]*A-Me2*B;
+          if( value > 0. ) sum += fWeight[m]*value;
+        }
+      photons[k] = sum/density;
+    }
+}
@@ -0,0 +1,142 @@
+#ifndef _YIELD_H
+#define _YIELD_H
+
+#include <vector>
+#include <cmath>
+
+using namespace std;
+
+
+
+/*!
+  Cherenkov yield of a single electron/positron in a given spectral band (see Eq. 2 in Nerling et al. (2006)).
+  The wavelength integral \f$ \int \epsilon(\lambda) / \lambda^2 d\lambda \f$ only depends on the band and on the
+  wavelength efficiency, it is therefore computed once at construction and each yield evaluation reduces to a few
+  arithmetic operations.
+ */
+class TCherenkovYield
+{
+  public :
+    //! Constructor for a flat wavelength efficiency between waveMin and waveMax (in cm)
+    TCherenkovYield(double waveMin, double waveMax);
+
+    //! Constructor for a wavelength efficiency tabulated in (wave, efficiency), wave in cm
+    TCherenkovYield(double waveMin, double waveMax, const vector<double> & wave, const vector<double> & efficiency);
+
+    //! Returns #fWaveMin
+    double GetWaveMin() const {return fWaveMin;}
+
+    //! Returns #fWaveMax
+    double GetWaveMax() const {return fWaveMax;}
+
+    //! Returns #fBandIntegral
+    double GetBandIntegral() const {return fBandIntegral;}
+
+    //! Wavelength efficiency at wave (in cm), 1 within the band for a flat efficiency
+    double Efficiency(double wave) const;
+
+    //! Energy threshold condition for Cherenkov in air (in MeV)
+    double EnergyThreshold(double delta) const {return fMe/sqrt(2*delta);}
+
+    //! Number of Cherenkov photons produced by a electron/positron of energy in MeV per \f$ g . cm^{-2} \f$
+    double Yield(double energy, double delta, double density) const
+    {
+      double threshold = 2.*delta-fMe2/(energy*energy);
+      if( threshold <= 0. ) return 0.; // below the Cherenkov energy threshold
+
+      return fFactor*threshold/density;
+    }
+
+  private :
+    //! Minimum wavelength of Cherenkov photons produced
+    double fWaveMin;
+
+    //! Maximum wavelength of Cherenkov photons produced
+    double fWaveMax;
+
+    //! \f$ \int \epsilon(\lambda) / \lambda^2 d\lambda \f$ over the band
+    double fBandIntegral;
+
+    //! Wavelengths in cm at which the efficiency is tabulated (empty for a flat efficiency)
+    vector<double> fWave;
+
+    //! Tabulated wavelength efficiency
+    vector<double> fEfficiency;
+
+    //! \f$ 2 \pi \alpha \f$ times #fBandIntegral
+    double fFactor;
+
+    //! Mass of the electron in MeV
+    double fMe;
+
+    //! Square of #fMe
+    double fMe2;
+
+    //! Initializes #fFactor, #fMe and #fMe2 once #fBandIntegral is known
+    void Init();
+};
+
+
+
+/*!
+  Refractivity n-1 of air at wave relative to its value at waveReference (both in cm), from the dispersion formula of
+  Edlen (1966). The density dependence factors out, so the ratio is the same at all altitudes.
+ */
+double RefractivityRatio(double wave, double waveReference = 400.e-7);
+
+
+
+/*!
+  Cherenkov yield of a single electron/positron resolved in nBins wavelength bins of equal width over the band of a
+  TCherenkovYield, with the dispersive index of refraction \f$ \delta(\lambda, h) = \delta(h) r(\lambda) \f$, where
+  \f$ \delta(h) \f$ is the value tabulated in the atmosphere (taken at 400 nm). Both the ratio r and the quadrature
+  weights \f$ \epsilon(\lambda) / \lambda^2 \f$ of the kSamples wavelengths of each bin are computed once at
+  construction. The energy threshold then depends on the wavelength, so the electron energy spectrum S (per unit of
+  ln E) enters through its tail integrals above each threshold:
+  \f[ \frac{dN_k}{dX} = \frac{2 \pi \alpha}{\rho} \int_k \frac{\epsilon(\lambda)}{\lambda^2}
+       \left[ 2 \delta r(\lambda) \int_{E_{th}(\lambda)} S d\ln E - m_e^2 \int_{E_{th}(\lambda)} \frac{S}{E^2} d\ln E \right] d\lambda \f]
+ */
+class TSpectralYield
+{
+  public :
+    //! Constructor with the ratio r of Edlen (see #RefractivityRatio)
+    TSpectralYield(const TCherenkovYield & yield, unsigned int nBins);
+
+    //! Constructor with the ratio r tabulated in (wave, ratio), wave in cm
+    TSpectralYield(const TCherenkovYield & yield, unsigned int nBins, const vector<double> & wave, const vector<double> & ratio);
+
+    //! Number of wavelength bins
+    unsigned int GetNumberOfBins() const {return fWave.size();}
+
+    //! Returns #fWave
+    const vector<double> & GetWave() const {return fWave;}
+
+    /*!
+      Number of Cherenkov photons produced per \f$ g . cm^{-2} \f$ in each bin, written in photons, for the tail
+      integrals tail0[j] and tail2[j] of S and \f$ S/E^2 \f$ in ln E above the size energies \f$ E_j \f$ (in MeV)
+      uniformly spaced in logarithm from logEnergyMin by step
+     */
+    void Yield(unsigned int size, double logEnergyMin, double step, const double * tail0, const double * tail2,
+               double delta, double density, double * photons) const;
+
+  private :
+    //! Number of wavelengths sampled in each bin (Newton-Cotes 5 points)
+    static const unsigned int kSamples = 5;
+
+    //! Samples the bins, with the ratio r tabulated in (wave, ratio) or from Edlen if empty
+    void Init(const TCherenkovYield & yield, unsigned int nBins, const vector<double> & wave, const vector<double> & ratio);
+
+    //! Center of the bins in cm
+    vector<double> fWave;
+
+    //! Ratio r at each sampled wavelength (bin k, sample s at index k*kSamples+s)
+    vector<double> fRatio;
+
+    //! Shift of the logarithm of the energy threshold at each sampled wavelength, \f$ -\ln(r)/2 \f$
+    vector<double> fLogThresholdShift;
+
+    //! \f$ 2 \pi \alpha \epsilon(\lambda) / \lambda^2 \f$ times the quadrature weight of each sampled wavelength
+    vector<double> fWeight;
+};
+
+#endif